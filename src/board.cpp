@@ -1,10 +1,14 @@
 #include "board.h"
 #include "util.h"
+#include "topology.h"
 
 #include <vector>
 #include <algorithm>
+#include <random>
 
-std::vector<Board::Pos> Board::getNeighbors(Board::Pos p) const
+template <typename T>
+std::vector<typename BasicBoard<T>::Pos> BasicBoard<T>::getNeighbors(
+    Pos p) const
 {
     std::vector<Pos> neighbors;
     if (p == POS_UNDEFINED)
@@ -12,153 +16,380 @@ std::vector<Board::Pos> Board::getNeighbors(Board::Pos p) const
         return neighbors;
     }
 
-    Pos r = getRow(p);
-    Pos c = getCol(p);
-
-    for (Pos i = -1; i <= 1; i ++)
-    {
-        for (Pos j = -1; j <= 1; j++)
-        {
-            if (i == 0 && j == 0)
-            {
-                continue;
-            }
-            Pos y = r + i;
-            Pos x = c + j;
-            if (y < 0 || y >= m_NRows || x < 0 || x >= m_NCols)
-            {
-                continue;
-            }
-            neighbors.push_back(convertPos(y, x));
-        }
-    }
+    forEachNeighbor<Topology>(getDims(), p, [&](Pos np) {
+        neighbors.push_back(np);
+    });
     return neighbors;
 }
 
-void Board::initCellValues(Board::Pos safePos)
+template <typename T>
+void BasicBoard<T>::initCellValues(BasicBoard<T>::Pos safePos)
 {
-    std::vector<Size> mines(m_NRows * m_NCols);
+    std::vector<Pos> mines(getNCells());
     for (Size i = 0; i < mines.size(); i ++)
     {
         mines[i] = i;
     }
-    std::shuffle(mines.begin(), mines.end(), Util::getRNG());
+    std::seed_seq seq = {static_cast<uint32_t>(m_Seed),
+        static_cast<uint32_t>(m_Seed >> 32)};
+    std::mt19937 rng(seq);
+    std::shuffle(mines.begin(), mines.end(), rng);
 
+    Dims dims = getDims();
     Size i = 0, nMines = 0;
     while (nMines < m_NMines && i < mines.size())
     {
         if (mines[i] != safePos)
         {
-            m_Cells[mines[i]].m_Value = Cell::MINE;
+            getMutableCell(mines[i]).m_Value = Cell::MINE;
             nMines ++;
-            for (Pos p : getNeighbors(mines[i]))
-            {
-                if (m_Cells[p].m_Value != Cell::MINE)
+            forEachNeighbor<Topology>(dims, mines[i], [&](Pos p) {
+                if (getCell(p).m_Value != Cell::MINE)
                 {
-                    m_Cells[p].m_Value ++;
+                    getMutableCell(p).m_Value ++;
                 }
-            }
+            });
         }
         i ++;
     }
     m_NMines = nMines;
+    count3BV();
     m_Timer.start();
 }
 
-void Board::open(Board::Pos p)
+template <typename T>
+void BasicBoard<T>::count3BV()
+{
+    Dims dims = getDims();
+    std::vector<bool> marked(getNCells(), false);
+    std::vector<Pos> stack;
+    m_3BV = 0;
+
+    // Each opening is one click: the zeros connected to it and their border
+    for (Pos p = 0; p < getNCells(); p ++)
+    {
+        if (getCell(p).m_Value != 0 || marked[p])
+        {
+            continue;
+        }
+        m_3BV ++;
+        marked[p] = true;
+        stack.push_back(p);
+        while (!stack.empty())
+        {
+            Pos q = stack.back();
+            stack.pop_back();
+            if (getCell(q).m_Value != 0)
+            {
+                continue;
+            }
+            forEachNeighbor<Topology>(dims, q, [&](Pos np) {
+                if (!marked[np])
+                {
+                    marked[np] = true;
+                    stack.push_back(np);
+                }
+            });
+        }
+    }
+
+    // Every other number takes a click of its own
+    for (Pos p = 0; p < getNCells(); p ++)
+    {
+        if (!marked[p] && getCell(p).m_Value != Cell::MINE)
+        {
+            m_3BV ++;
+        }
+    }
+}
+
+template <typename T>
+void BasicBoard<T>::open(Pos p)
+{
+    m_NClicks ++;
+    beginStep();
+    openCell(p);
+    checkWon();
+    endStep();
+}
+
+template <typename T>
+typename BasicBoard<T>::Delta BasicBoard<T>::apply(const Command *commands,
+    size_t nCommands)
+{
+    Delta delta;
+    delta.before = m_State;
+    m_Delta = &delta;
+    m_NClicks += static_cast<uint32_t>(nCommands);
+
+    beginStep();
+    for (size_t i = 0; i < nCommands && m_State != LOST; i ++)
+    {
+        Pos p = commands[i].pos;
+        switch (commands[i].type)
+        {
+            case Command::OPEN:
+                openCell(p);
+                break;
+            case Command::FLAG:
+                // A finished game is left as it is, as openCell() does
+                if (p != POS_UNDEFINED && m_State != WON && m_State != LOST
+                    && (getCell(p).m_State == Cell::HIDDEN
+                        || getCell(p).m_State == Cell::UNKNOWN))
+                {
+                    setState(p, Cell::FLAGGED);
+                    m_NFlagged ++;
+                }
+                break;
+            case Command::CHORD:
+                if (p != POS_UNDEFINED && getCell(p).m_State == Cell::SHOWN)
+                {
+                    openCell(p);
+                }
+                break;
+        }
+    }
+    checkWon();
+    endStep();
+
+    m_Delta = nullptr;
+    delta.after = m_State;
+    return delta;
+}
+
+template <typename T>
+void BasicBoard<T>::openCell(Pos p)
 {
     if (p == POS_UNDEFINED || m_State == WON || m_State == LOST
-        || m_Cells[p].m_State == Cell::FLAGGED
-        || m_Cells[p].m_State == Cell::UNKNOWN)
+        || getCell(p).m_State == Cell::FLAGGED
+        || getCell(p).m_State == Cell::UNKNOWN)
     {
         return;
     }
 
-
     if (m_State == INIT)
     {
         initCellValues(p);
         m_State = PLAYING;
     }
 
-    openRecur(p);
+    openRegion(p);
+}
 
-    if (m_State != LOST && m_NHidden == m_NMines)
+template <typename T>
+void BasicBoard<T>::checkWon()
+{
+    if (m_State == PLAYING && m_NHidden == m_NMines)
     {
         m_State = WON;
         m_Timer.stop();
     }
 }
 
-void Board::openRecur(Board::Pos p)
+template <typename T>
+void BasicBoard<T>::setState(Pos p, typename Cell::State state)
 {
-    if (m_Cells[p].m_State != Cell::SHOWN)
+    Cell &cell = getMutableCell(p);
+    m_Hash ^= getZobristKey(p, cell);
+    cell.m_State = state;
+    m_Hash ^= getZobristKey(p, cell);
+    if (m_Delta != nullptr)
     {
-        m_Cells[p].m_State = Cell::SHOWN;
-        m_NHidden --;
+        m_Delta->changed.push_back(p);
     }
+}
 
-    if (m_Cells[p].m_Value == Cell::MINE)
+template <typename T>
+void BasicBoard<T>::openRegion(Pos p)
+{
+    // A region can cover the whole board, so the flood fill keeps its own
+    // stack instead of recursing. Cells are shown as they are pushed, which
+    // keeps each of them on the stack at most once.
+    Dims dims = getDims();
+    std::vector<Pos> stack;
+    if (getCell(p).m_State != Cell::SHOWN)
     {
-        m_State = LOST;
-        m_Timer.stop();
-        return;
+        setState(p, Cell::SHOWN);
+        m_NHidden --;
     }
+    stack.push_back(p);
 
-    std::vector<Pos> neighbors = getNeighbors(p);
-    Size nMineFound = 0;
-
-    for (Pos np: neighbors)
+    while (!stack.empty())
     {
-        if (m_Cells[np].m_State == Cell::FLAGGED)
+        Pos q = stack.back();
+        stack.pop_back();
+
+        if (getCell(q).m_Value == Cell::MINE)
         {
-            nMineFound ++;
+            m_State = LOST;
+            m_Timer.stop();
+            continue;
         }
-    }
 
-    if (nMineFound >= m_Cells[p].m_Value)
-    {
-        for (Pos np : neighbors)
-        {
-            if (m_Cells[np].m_State != Cell::SHOWN
-                && m_Cells[np].m_State != Cell::FLAGGED)
+        Size nMineFound = 0;
+        forEachNeighbor<Topology>(dims, q, [&](Pos np) {
+            if (getCell(np).m_State == Cell::FLAGGED)
             {
-                openRecur(np);
+                nMineFound ++;
             }
+        });
+
+        if (nMineFound < getCell(q).m_Value)
+        {
+            continue;
         }
+
+        forEachNeighbor<Topology>(dims, q, [&](Pos np) {
+            if (getCell(np).m_State != Cell::SHOWN
+                && getCell(np).m_State != Cell::FLAGGED)
+            {
+                setState(np, Cell::SHOWN);
+                m_NHidden --;
+                stack.push_back(np);
+            }
+        });
     }
 }
 
-void Board::nextState(Board::Pos p)
+template <typename T>
+void BasicBoard<T>::nextState(Pos p)
 {
     if (p == POS_UNDEFINED)
     {
         return;
     }
 
-    switch (m_Cells[p].m_State)
+    m_NClicks ++;
+    beginStep();
+    switch (getCell(p).m_State)
     {
         case Cell::HIDDEN:
-            m_Cells[p].m_State = Cell::FLAGGED;
+            setState(p, Cell::FLAGGED);
             m_NFlagged ++;
             break;
         case Cell::FLAGGED:
-            m_Cells[p].m_State = Cell::UNKNOWN;
+            setState(p, Cell::UNKNOWN);
             m_NFlagged --;
             break;
         case Cell::UNKNOWN:
-            m_Cells[p].m_State = Cell::HIDDEN;
+            setState(p, Cell::HIDDEN);
             break;
         default:
             break;
     }
+    endStep();
+}
+
+template <typename T>
+typename BasicBoard<T>::Cell &BasicBoard<T>::getMutableCell(Pos p)
+{
+    size_t i = p / CHUNK_SIZE;
+    if (!m_UndoSteps.empty() && m_ChunkSteps[i] != m_NSteps)
+    {
+        // First write to this chunk in the current step: keep the old
+        // version for undo, which also forces the copy below.
+        m_ChunkSteps[i] = m_NSteps;
+        m_UndoSteps.back().chunks.emplace_back(i, m_Chunks[i]);
+    }
+    if (m_Chunks[i].use_count() > 1)
+    {
+        m_Chunks[i] = std::make_shared<Chunk>(*m_Chunks[i]);
+    }
+    return (*m_Chunks[i])[p % CHUNK_SIZE];
+}
+
+template <typename T>
+void BasicBoard<T>::beginStep()
+{
+    m_NSteps ++;
+    m_UndoSteps.push_back({m_State, m_NMines, m_NHidden, m_NFlagged, m_Hash,
+        {}});
+}
+
+template <typename T>
+void BasicBoard<T>::endStep()
+{
+    const Step &step = m_UndoSteps.back();
+    if (step.chunks.empty() && step.state == m_State
+        && step.nFlagged == m_NFlagged)
+    {
+        // Nothing changed, e.g. opening an already shown cell
+        m_UndoSteps.pop_back();
+        return;
+    }
+    m_RedoSteps.clear();
+}
+
+template <typename T>
+void BasicBoard<T>::swapStep(Step &step)
+{
+    State state = m_State;
+
+    std::swap(m_State, step.state);
+    std::swap(m_NMines, step.nMines);
+    std::swap(m_NHidden, step.nHidden);
+    std::swap(m_NFlagged, step.nFlagged);
+    std::swap(m_Hash, step.hash);
+    for (auto &chunk : step.chunks)
+    {
+        std::swap(m_Chunks[chunk.first], chunk.second);
+    }
+
+    if (m_State == INIT)
+    {
+        m_Timer.reset();
+        return;
+    }
+
+    if (state == INIT)
+    {
+        m_Timer.start();
+    }
+    else
+    {
+        m_Timer.resume();
+    }
+    if (m_State != PLAYING)
+    {
+        m_Timer.stop();
+    }
+}
+
+template <typename T>
+void BasicBoard<T>::undo()
+{
+    if (m_UndoSteps.empty())
+    {
+        return;
+    }
+    m_RedoSteps.push_back(std::move(m_UndoSteps.back()));
+    m_UndoSteps.pop_back();
+    swapStep(m_RedoSteps.back());
 }
 
-Board::Size Board::getNMinesRemaining() const
+template <typename T>
+void BasicBoard<T>::redo()
+{
+    if (m_RedoSteps.empty())
+    {
+        return;
+    }
+    m_UndoSteps.push_back(std::move(m_RedoSteps.back()));
+    m_RedoSteps.pop_back();
+    swapStep(m_UndoSteps.back());
+}
+
+template <typename T>
+typename BasicBoard<T>::Size BasicBoard<T>::getNMinesRemaining() const
 {
     if (m_State == WON)
     {
         return 0;
     }
-    return std::max(0, m_NMines - m_NFlagged);
+    return m_NMines > m_NFlagged ? m_NMines - m_NFlagged : 0;
 }
+
+template class BasicBoard<SquareTopology>;
+template class BasicBoard<TorusTopology>;
+template class BasicBoard<HexTopology>;
+template class BasicBoard<CubeTopology>;
@@ -3,18 +3,33 @@
 
 #include "util.h"
 #include "timer.h"
+#include "topology.h"
 
+#include <array>
 #include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <utility>
 #include <vector>
 
-class Board
+#ifndef CANH_TOPOLOGY
+#   define CANH_TOPOLOGY SquareTopology
+#endif
+
+template <typename TopologyT>
+class BasicBoard
 {
 public:
-    typedef int16_t Pos;
-    typedef uint16_t Size;
+    typedef TopologyT Topology;
+    typedef int32_t Pos;
+    typedef uint32_t Size;
+    typedef uint64_t Seed;
 
     static const Pos POS_UNDEFINED = -1;
 
+    // Most cells a board can have, layers included
+    static const Size MAX_N_CELLS = INT32_MAX;
+
     class Cell
     {
     public:
@@ -35,7 +50,7 @@ public:
         State m_State;
         Value m_Value;
 
-        friend class Board;
+        friend class BasicBoard;
     };
 
     enum State
@@ -46,54 +61,184 @@ public:
         LOST
     };
 
-    Board(Size nRows, Size nCols, Size nMines)
+    struct Command
+    {
+        enum Type
+        {
+            OPEN,
+            FLAG,
+            CHORD
+        };
+
+        Type type;
+        Pos pos;
+    };
+
+    // Result of apply(): the game state before and after the batch, and every
+    // cell whose state changed, in order (a cell may appear more than once).
+    struct Delta
+    {
+        State before;
+        State after;
+        std::vector<Pos> changed;
+    };
+
+    // The mines are a function of the seed and the first opened cell
+    BasicBoard(Size nRows, Size nCols, Size nMines, Size nLayers = 1,
+        Seed seed = Util::getRNG()())
         : m_State(INIT),
+        m_NLayers(nLayers),
         m_NRows(nRows),
         m_NCols(nCols),
         m_NMines(nMines),
-        m_NHidden(nRows * nCols),
+        m_NHidden(nLayers * nRows * nCols),
         m_NFlagged(0),
+        m_Seed(seed),
+        m_NClicks(0),
+        m_3BV(0),
         m_Timer(),
-        m_Cells(nRows * nCols)
+        m_Hash(0),
+        m_Chunks((getNCells() + CHUNK_SIZE - 1) / CHUNK_SIZE),
+        m_ChunkSteps(m_Chunks.size(), 0),
+        m_NSteps(0),
+        m_Delta(nullptr)
     {
+        ASSERT(nLayers == 1 || Topology::LAYERED);
+        for (std::shared_ptr<Chunk> &chunk : m_Chunks)
+        {
+            chunk = std::make_shared<Chunk>();
+        }
     }
 
-    Cell::State getState(Pos p) const { return m_Cells[p].m_State; }
-    Cell::Value getValue(Pos p) const { return m_Cells[p].m_Value; }
+    typename Cell::State getState(Pos p) const { return getCell(p).m_State; }
+    typename Cell::Value getValue(Pos p) const { return getCell(p).m_Value; }
 
+    State getGameState() const { return m_State; }
     bool isWon() const { return m_State == WON; }
     bool isLost() const { return m_State == LOST; }
 
+    Size getNLayers() const { return m_NLayers; }
     Size getNRows() const { return m_NRows; }
     Size getNCols() const { return m_NCols; }
     Size getNMines() const { return m_NMines; }
-    Size getNCells() const { return m_NRows * m_NCols; }
+    // A Pos, so that positions compare with it directly
+    Pos getNCells() const
+    {
+        return static_cast<Pos>(m_NLayers * m_NRows * m_NCols);
+    }
+    Dims getDims() const
+    {
+        return {static_cast<int>(m_NLayers), static_cast<int>(m_NRows),
+            static_cast<int>(m_NCols)};
+    }
 
     Size getNMinesRemaining() const;
 
+    Seed getSeed() const { return m_Seed; }
+
+    // Every open, flag and batched command counts, undo and redo do not
+    uint32_t getNClicks() const { return m_NClicks; }
+
+    // Bechtel's Board Benchmark Value: the fewest clicks that clear the
+    // board, one per opening plus one per number not next to an opening.
+    // Zero until the mines are placed.
+    Size get3BV() const { return m_3BV; }
+
+    // Zobrist hash of what the player sees (cell states and shown values),
+    // kept up to date on every state change and restored by undo/redo.
+    uint64_t getHash() const { return m_Hash; }
+
     Timer::Sec getElapsedSec() const { return m_Timer.getSecond(); }
 
-    Pos convertPos(Pos r, Pos c) const { return r * m_NCols + c; }
-    Pos getRow(Pos p) const { return p / m_NCols; }
+    Pos convertPos(Pos r, Pos c, Pos l = 0) const
+    {
+        return (l * m_NRows + r) * m_NCols + c;
+    }
+    Pos getLayer(Pos p) const { return p / (m_NRows * m_NCols); }
+    Pos getRow(Pos p) const { return p % (m_NRows * m_NCols) / m_NCols; }
     Pos getCol(Pos p) const { return p % m_NCols; }
     std::vector<Pos> getNeighbors(Pos p) const;
 
     void open(Pos p);
     void nextState(Pos p);
 
+    // Applies the commands in order as a single move: one undo step and one
+    // win check at the end. Commands after a mine is hit are ignored.
+    Delta apply(const Command *commands, size_t nCommands);
+
+    bool canUndo() const { return !m_UndoSteps.empty(); }
+    bool canRedo() const { return !m_RedoSteps.empty(); }
+    void undo();
+    void redo();
+
 private:
+    // Cells are stored in shared, fixed-size chunks. A chunk is copied only
+    // when it is written while something else (an undo step) still refers
+    // to it, so each move costs memory proportional to the chunks it touched.
+    static const Size CHUNK_SIZE = 64;
+    typedef std::array<Cell, CHUNK_SIZE> Chunk;
+
+    struct Step
+    {
+        State state;
+        Size nMines;
+        Size nHidden;
+        Size nFlagged;
+        uint64_t hash;
+        std::vector<std::pair<size_t, std::shared_ptr<Chunk>>> chunks;
+    };
+
     State m_State;
+    Size m_NLayers;
     Size m_NRows;
     Size m_NCols;
     Size m_NMines;
     Size m_NHidden;
     Size m_NFlagged;
+    Seed m_Seed;
+    uint32_t m_NClicks;
+    Size m_3BV;
     Timer m_Timer;
+    uint64_t m_Hash;
 
-    std::vector<Cell> m_Cells;
+    std::vector<std::shared_ptr<Chunk>> m_Chunks;
+    std::vector<uint32_t> m_ChunkSteps;
+    uint32_t m_NSteps;
+    std::vector<Step> m_UndoSteps;
+    std::vector<Step> m_RedoSteps;
+    Delta *m_Delta;
+
+    const Cell &getCell(Pos p) const
+    {
+        return (*m_Chunks[p / CHUNK_SIZE])[p % CHUNK_SIZE];
+    }
+    Cell &getMutableCell(Pos p);
+
+    // Hidden cells have a zero key, so a fresh board hashes to zero
+    static uint64_t getZobristKey(Pos p, const Cell &cell)
+    {
+        if (cell.m_State == Cell::HIDDEN)
+        {
+            return 0;
+        }
+        uint64_t symbol = cell.m_State == Cell::SHOWN
+            ? Cell::SHOWN + cell.m_Value : cell.m_State;
+        return Util::mix(static_cast<uint64_t>(p) << 8 | symbol);
+    }
+
+    void beginStep();
+    void endStep();
+    void swapStep(Step &step);
+
+    void setState(Pos p, typename Cell::State state);
 
     void initCellValues(Pos safePos);
-    void openRecur(Pos p);
+    void count3BV();
+    void openCell(Pos p);
+    void openRegion(Pos p);
+    void checkWon();
 };
 
+typedef BasicBoard<CANH_TOPOLOGY> Board;
+
 #endif
@@ -0,0 +1,467 @@
+#include "capi/minesweeper.h"
+#include "board.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct mswp_board
+{
+    std::unique_ptr<Board> board;
+    std::vector<Board::Command> commands;
+
+    // Planes live in the vector, or after the header of the shared mapping
+    std::vector<uint8_t> planes;
+    std::string shmName;
+    mswp_shared_header *header;
+    size_t mappingSize;
+
+    uint8_t *states;
+    uint8_t *values;
+};
+
+namespace
+{
+    thread_local std::string lastError;
+
+    const uint64_t PLANES_OFFSET = 64;
+
+    // Also called from catch blocks, so it must not throw itself
+    int fail(const char *msg) noexcept
+    {
+        try
+        {
+            lastError = msg;
+        }
+        catch (...)
+        {
+            lastError.clear();
+        }
+        return MSWP_ERROR;
+    }
+
+    // Names the shared memory object the message is about
+    int fail(const char *msg, const char *name) noexcept
+    {
+        try
+        {
+            lastError = std::string(msg) + " \"" + name + "\"";
+        }
+        catch (...)
+        {
+            lastError.clear();
+        }
+        return MSWP_ERROR;
+    }
+
+    bool isValidSize(uint32_t nRows, uint32_t nCols, uint32_t nMines,
+        uint32_t nLayers)
+    {
+        uint64_t nCells = static_cast<uint64_t>(nLayers) * nRows * nCols;
+        if (nCells == 0 || nCells > Board::MAX_N_CELLS || nMines >= nCells)
+        {
+            fail("Invalid board size");
+            return false;
+        }
+        if (nLayers != 1 && !Board::Topology::LAYERED)
+        {
+            fail("The board topology has no layers");
+            return false;
+        }
+        return true;
+    }
+
+    size_t getMappingSize(uint64_t nCells)
+    {
+        return PLANES_OFFSET + 2 * nCells;
+    }
+
+    // Readers of a shared board retry while the sequence is odd
+    void beginUpdate(mswp_board *b)
+    {
+        if (b->header != nullptr)
+        {
+            __atomic_store_n(&b->header->sequence, b->header->sequence + 1,
+                __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+        }
+    }
+
+    void endUpdate(mswp_board *b)
+    {
+        if (b->header != nullptr)
+        {
+            b->header->game_state = b->board->getGameState();
+            __atomic_store_n(&b->header->sequence, b->header->sequence + 1,
+                __ATOMIC_RELEASE);
+        }
+    }
+
+    void updateCell(mswp_board *b, Board::Pos p)
+    {
+        Board::Cell::State state = b->board->getState(p);
+        b->states[p] = static_cast<uint8_t>(state);
+        b->values[p] = state == Board::Cell::SHOWN
+            ? b->board->getValue(p) : MSWP_VALUE_HIDDEN;
+    }
+
+    // After a move failed half way, nobody knows which cells it changed
+    void updateAllCells(mswp_board *b)
+    {
+        beginUpdate(b);
+        for (Board::Pos p = 0; p < b->board->getNCells(); p ++)
+        {
+            updateCell(b, p);
+        }
+        endUpdate(b);
+    }
+
+    void newGame(mswp_board *b, uint32_t nRows, uint32_t nCols,
+        uint32_t nMines, uint32_t nLayers, uint64_t seed)
+    {
+        b->board.reset(new Board(nRows, nCols, nMines, nLayers, seed));
+        size_t nCells = b->board->getNCells();
+        beginUpdate(b);
+        std::memset(b->states, MSWP_CELL_HIDDEN, nCells);
+        std::memset(b->values, MSWP_VALUE_HIDDEN, nCells);
+        endUpdate(b);
+    }
+
+    bool isValidPos(const mswp_board *b, int32_t pos)
+    {
+        if (pos < 0 || pos >= static_cast<int32_t>(b->board->getNCells()))
+        {
+            fail("Position out of the board");
+            return false;
+        }
+        return true;
+    }
+}
+
+extern "C" {
+
+int mswp_abi_version(void)
+{
+    return MSWP_ABI_VERSION;
+}
+
+const char *mswp_last_error(void)
+{
+    return lastError.c_str();
+}
+
+mswp_board *mswp_create(uint32_t n_rows, uint32_t n_cols, uint32_t n_mines,
+    uint32_t n_layers, uint64_t seed)
+{
+    if (!isValidSize(n_rows, n_cols, n_mines, n_layers))
+    {
+        return nullptr;
+    }
+
+    // No exception may reach the C caller, and a large board can easily
+    // run out of memory
+    try
+    {
+        std::unique_ptr<mswp_board> b(new mswp_board());
+        size_t nCells = static_cast<size_t>(n_layers) * n_rows * n_cols;
+        b->planes.resize(2 * nCells);
+        b->header = nullptr;
+        b->mappingSize = 0;
+        b->states = b->planes.data();
+        b->values = b->planes.data() + nCells;
+        newGame(b.get(), n_rows, n_cols, n_mines, n_layers, seed);
+        return b.release();
+    }
+    catch (const std::exception &e)
+    {
+        fail(e.what());
+        return nullptr;
+    }
+}
+
+mswp_board *mswp_create_shared(const char *name, uint32_t n_rows,
+    uint32_t n_cols, uint32_t n_mines, uint32_t n_layers, uint64_t seed)
+{
+    if (!isValidSize(n_rows, n_cols, n_mines, n_layers))
+    {
+        return nullptr;
+    }
+
+    uint64_t nCells = static_cast<uint64_t>(n_layers) * n_rows * n_cols;
+    size_t size = getMappingSize(nCells);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0)
+    {
+        fail("Can not create shared memory", name);
+        return nullptr;
+    }
+    void *data = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(size)) == 0)
+    {
+        data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        shm_unlink(name);
+        fail("Can not map shared memory", name);
+        return nullptr;
+    }
+
+    try
+    {
+        std::unique_ptr<mswp_board> b(new mswp_board());
+        b->shmName = name;
+        b->header = static_cast<mswp_shared_header *>(data);
+        b->mappingSize = size;
+        b->header->magic = MSWP_SHARED_MAGIC;
+        b->header->abi_version = MSWP_ABI_VERSION;
+        b->header->sequence = 0;
+        b->header->n_layers = n_layers;
+        b->header->n_rows = n_rows;
+        b->header->n_cols = n_cols;
+        b->header->n_mines = n_mines;
+        b->header->states_offset = PLANES_OFFSET;
+        b->header->values_offset = PLANES_OFFSET + nCells;
+        b->states = static_cast<uint8_t *>(data) + PLANES_OFFSET;
+        b->values = b->states + nCells;
+        newGame(b.get(), n_rows, n_cols, n_mines, n_layers, seed);
+        return b.release();
+    }
+    catch (const std::exception &e)
+    {
+        munmap(data, size);
+        shm_unlink(name);
+        fail(e.what());
+        return nullptr;
+    }
+}
+
+void mswp_destroy(mswp_board *board)
+{
+    if (board == nullptr)
+    {
+        return;
+    }
+    if (board->header != nullptr)
+    {
+        munmap(board->header, board->mappingSize);
+        shm_unlink(board->shmName.c_str());
+    }
+    delete board;
+}
+
+int mswp_reset(mswp_board *board, uint64_t seed)
+{
+    // The old game stays when the new one can not be made
+    try
+    {
+        const Board &old = *board->board;
+        newGame(board, old.getNRows(), old.getNCols(), old.getNMines(),
+            old.getNLayers(), seed);
+        return MSWP_OK;
+    }
+    catch (const std::exception &e)
+    {
+        return fail(e.what());
+    }
+}
+
+int mswp_apply(mswp_board *board, const mswp_command *commands, size_t n)
+{
+    try
+    {
+        board->commands.resize(n);
+    }
+    catch (const std::exception &e)
+    {
+        return fail(e.what());
+    }
+    for (size_t i = 0; i < n; i ++)
+    {
+        if (!isValidPos(board, commands[i].pos))
+        {
+            return MSWP_ERROR;
+        }
+        switch (commands[i].type)
+        {
+            case MSWP_OPEN:
+                board->commands[i].type = Board::Command::OPEN;
+                break;
+            case MSWP_FLAG:
+                board->commands[i].type = Board::Command::FLAG;
+                break;
+            case MSWP_CHORD:
+                board->commands[i].type = Board::Command::CHORD;
+                break;
+            default:
+                return fail("Unknown command type");
+        }
+        board->commands[i].pos = static_cast<Board::Pos>(commands[i].pos);
+    }
+
+    // Only the cells the move touched are copied to the planes
+    try
+    {
+        Board::Delta delta = board->board->apply(board->commands.data(), n);
+        beginUpdate(board);
+        for (Board::Pos p : delta.changed)
+        {
+            updateCell(board, p);
+        }
+        endUpdate(board);
+        return MSWP_OK;
+    }
+    catch (const std::exception &e)
+    {
+        updateAllCells(board);
+        return fail(e.what());
+    }
+}
+
+int mswp_open(mswp_board *board, int32_t pos)
+{
+    mswp_command command = {MSWP_OPEN, pos};
+    return mswp_apply(board, &command, 1);
+}
+
+int mswp_flag(mswp_board *board, int32_t pos)
+{
+    mswp_command command = {MSWP_FLAG, pos};
+    return mswp_apply(board, &command, 1);
+}
+
+int mswp_toggle(mswp_board *board, int32_t pos)
+{
+    if (!isValidPos(board, pos))
+    {
+        return MSWP_ERROR;
+    }
+    Board::Pos p = static_cast<Board::Pos>(pos);
+    int result = MSWP_OK;
+    try
+    {
+        board->board->nextState(p);
+    }
+    catch (const std::exception &e)
+    {
+        result = fail(e.what());
+    }
+    beginUpdate(board);
+    updateCell(board, p);
+    endUpdate(board);
+    return result;
+}
+
+int mswp_game_state(const mswp_board *board)
+{
+    return board->board->getGameState();
+}
+
+uint32_t mswp_n_layers(const mswp_board *board)
+{
+    return board->board->getNLayers();
+}
+
+uint32_t mswp_n_rows(const mswp_board *board)
+{
+    return board->board->getNRows();
+}
+
+uint32_t mswp_n_cols(const mswp_board *board)
+{
+    return board->board->getNCols();
+}
+
+uint32_t mswp_n_mines(const mswp_board *board)
+{
+    return board->board->getNMines();
+}
+
+uint32_t mswp_n_mines_remaining(const mswp_board *board)
+{
+    return board->board->getNMinesRemaining();
+}
+
+uint32_t mswp_elapsed_sec(const mswp_board *board)
+{
+    return board->board->getElapsedSec();
+}
+
+uint64_t mswp_hash(const mswp_board *board)
+{
+    return board->board->getHash();
+}
+
+size_t mswp_n_cells(const mswp_board *board)
+{
+    return board->board->getNCells();
+}
+
+const uint8_t *mswp_states(const mswp_board *board)
+{
+    return board->states;
+}
+
+const uint8_t *mswp_values(const mswp_board *board)
+{
+    return board->values;
+}
+
+const mswp_shared_header *mswp_map_shared(const char *name)
+{
+    int fd = shm_open(name, O_RDONLY, 0);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0
+        || static_cast<size_t>(st.st_size) < PLANES_OFFSET)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        fail("Can not open shared memory", name);
+        return nullptr;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void *data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        fail("Can not map shared memory", name);
+        return nullptr;
+    }
+
+    const mswp_shared_header *header =
+        static_cast<const mswp_shared_header *>(data);
+    uint64_t nCells = static_cast<uint64_t>(header->n_layers)
+        * header->n_rows * header->n_cols;
+    if (header->magic != MSWP_SHARED_MAGIC
+        || header->abi_version != MSWP_ABI_VERSION
+        || getMappingSize(nCells) > size)
+    {
+        munmap(data, size);
+        fail("Not a shared board:", name);
+        return nullptr;
+    }
+    return header;
+}
+
+void mswp_unmap_shared(const mswp_shared_header *header)
+{
+    if (header == nullptr)
+    {
+        return;
+    }
+    uint64_t nCells = static_cast<uint64_t>(header->n_layers)
+        * header->n_rows * header->n_cols;
+    munmap(const_cast<mswp_shared_header *>(header), getMappingSize(nCells));
+}
+
+}
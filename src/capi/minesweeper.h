@@ -0,0 +1,145 @@
+#ifndef CANH_MINESWEEPER_H
+#define CANH_MINESWEEPER_H
+
+/* C interface to the game engine, built as libminesweeper.so by
+ * "make capi". Every call is made from one thread per board.
+ *
+ * Cells are addressed by position (layer * rows + row) * cols + col. The
+ * board keeps two planes of one byte per cell in that order, updated after
+ * every move: the state plane holds an MSWP_CELL_* state, and the value
+ * plane holds the number of neighbouring mines (MSWP_MINE for a mine) of a
+ * shown cell and MSWP_VALUE_HIDDEN for any other cell. Pointers to the
+ * planes stay valid until the board is destroyed, so analysers read them in
+ * place instead of querying cell by cell.
+ *
+ * A board created with mswp_create_shared() keeps its planes in a POSIX
+ * shared memory object instead, behind an mswp_shared_header. Other
+ * processes map it read-only with mswp_map_shared() and read it as a
+ * sequence lock: load the sequence, give up if it is odd, copy what is
+ * needed, and retry if the sequence has changed meanwhile.
+ *
+ * No call lets a C++ exception through: functions returning int return
+ * MSWP_ERROR and those returning a pointer return NULL, and
+ * mswp_last_error() tells why. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The library is built with hidden visibility, only these are exported */
+#define MSWP_API __attribute__((visibility("default")))
+
+#define MSWP_ABI_VERSION 1
+#define MSWP_SHARED_MAGIC 0x5057534Du /* "MSWP" */
+
+#define MSWP_MINE 9
+#define MSWP_VALUE_HIDDEN 0x0F
+
+enum
+{
+    MSWP_CELL_HIDDEN,
+    MSWP_CELL_FLAGGED,
+    MSWP_CELL_UNKNOWN,
+    MSWP_CELL_SHOWN
+};
+
+enum
+{
+    MSWP_GAME_INIT,
+    MSWP_GAME_PLAYING,
+    MSWP_GAME_WON,
+    MSWP_GAME_LOST
+};
+
+enum
+{
+    MSWP_OPEN,
+    MSWP_FLAG,
+    MSWP_CHORD
+};
+
+enum
+{
+    MSWP_OK = 0,
+    MSWP_ERROR = -1
+};
+
+typedef struct mswp_board mswp_board;
+
+typedef struct mswp_command
+{
+    uint8_t type;           /* MSWP_OPEN, MSWP_FLAG or MSWP_CHORD */
+    int32_t pos;
+} mswp_command;
+
+/* Start of a shared memory object, followed by the state plane at
+ * states_offset and the value plane at values_offset */
+typedef struct mswp_shared_header
+{
+    uint32_t magic;
+    uint32_t abi_version;
+    uint32_t sequence;      /* odd while the board is being updated */
+    uint32_t game_state;
+    uint32_t n_layers;
+    uint32_t n_rows;
+    uint32_t n_cols;
+    uint32_t n_mines;
+    uint64_t states_offset;
+    uint64_t values_offset;
+} mswp_shared_header;
+
+MSWP_API int mswp_abi_version(void);
+
+/* Message of the last failed call on this thread, empty if none */
+MSWP_API const char *mswp_last_error(void);
+
+/* The mines are a function of the seed and the first opened cell. Boards
+ * may have up to INT32_MAX cells; NULL is returned on failure, including
+ * when there is not enough memory. */
+MSWP_API mswp_board *mswp_create(uint32_t n_rows, uint32_t n_cols,
+    uint32_t n_mines, uint32_t n_layers, uint64_t seed);
+
+/* Same, with the planes in the shared memory object name (e.g. "/board"),
+ * which is created and removed again by mswp_destroy() */
+MSWP_API mswp_board *mswp_create_shared(const char *name, uint32_t n_rows,
+    uint32_t n_cols, uint32_t n_mines, uint32_t n_layers, uint64_t seed);
+
+MSWP_API void mswp_destroy(mswp_board *board);
+
+/* Starts a new game of the same size */
+MSWP_API int mswp_reset(mswp_board *board, uint64_t seed);
+
+/* Applies the commands as a single move, see Board::apply() */
+MSWP_API int mswp_apply(mswp_board *board, const mswp_command *commands,
+    size_t n);
+MSWP_API int mswp_open(mswp_board *board, int32_t pos);
+MSWP_API int mswp_flag(mswp_board *board, int32_t pos);
+
+/* Cycles a cell through hidden, flagged and unknown like a right click */
+MSWP_API int mswp_toggle(mswp_board *board, int32_t pos);
+
+MSWP_API int mswp_game_state(const mswp_board *board);
+MSWP_API uint32_t mswp_n_layers(const mswp_board *board);
+MSWP_API uint32_t mswp_n_rows(const mswp_board *board);
+MSWP_API uint32_t mswp_n_cols(const mswp_board *board);
+MSWP_API uint32_t mswp_n_mines(const mswp_board *board);
+MSWP_API uint32_t mswp_n_mines_remaining(const mswp_board *board);
+MSWP_API uint32_t mswp_elapsed_sec(const mswp_board *board);
+MSWP_API uint64_t mswp_hash(const mswp_board *board);
+MSWP_API size_t mswp_n_cells(const mswp_board *board);
+
+MSWP_API const uint8_t *mswp_states(const mswp_board *board);
+MSWP_API const uint8_t *mswp_values(const mswp_board *board);
+
+/* Maps a board shared by another process read-only, NULL on failure */
+MSWP_API const mswp_shared_header *mswp_map_shared(const char *name);
+MSWP_API void mswp_unmap_shared(const mswp_shared_header *header);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
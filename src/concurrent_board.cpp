@@ -0,0 +1,279 @@
+#include "concurrent_board.h"
+#include "board.h"
+#include "util.h"
+#include "topology.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+template <typename T>
+BasicConcurrentBoard<T>::BasicConcurrentBoard(Size nRows, Size nCols,
+    Size nMines, Size nLayers, Seed seed)
+    : m_State(BasicBoard<T>::INIT),
+    m_NLayers(nLayers),
+    m_NRows(nRows),
+    m_NCols(nCols),
+    m_NMines(nMines),
+    m_NHidden(nLayers * nRows * nCols),
+    m_NFlagged(0),
+    m_Seed(seed),
+    m_StartTime(0),
+    m_StopTime(0),
+    m_Cells(new std::atomic<uint8_t>[getNCells()])
+{
+    ASSERT(nLayers == 1 || Topology::LAYERED);
+    for (Size p = 0; p < getNCells(); p ++)
+    {
+        m_Cells[p].store(pack(Cell::HIDDEN, 0), std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+int64_t BasicConcurrentBoard<T>::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now().time_since_epoch()).count();
+}
+
+template <typename T>
+void BasicConcurrentBoard<T>::initCellValues(Pos safePos)
+{
+    std::vector<Pos> mines(getNCells());
+    for (Size i = 0; i < mines.size(); i ++)
+    {
+        mines[i] = i;
+    }
+    std::seed_seq seq = {static_cast<uint32_t>(m_Seed),
+        static_cast<uint32_t>(m_Seed >> 32)};
+    std::mt19937 rng(seq);
+    std::shuffle(mines.begin(), mines.end(), rng);
+
+    // Values are counted in private first: a neighbour may become a mine
+    // after it was counted, which the shared cells could not undo.
+    Dims dims = getDims();
+    std::vector<typename Cell::Value> values(getNCells(), 0);
+    Size i = 0, nMines = 0;
+    while (nMines < m_NMines && i < mines.size())
+    {
+        if (mines[i] != safePos)
+        {
+            values[mines[i]] = Cell::MINE;
+            nMines ++;
+            forEachNeighbor<Topology>(dims, mines[i], [&](Pos p) {
+                if (values[p] != Cell::MINE)
+                {
+                    values[p] ++;
+                }
+            });
+        }
+        i ++;
+    }
+
+    // Nobody reads the values before the game is PLAYING, but flags may be
+    // placed meanwhile. The value bits are still zero, so or-ing the value
+    // in leaves the state as it is.
+    for (Size p = 0; p < getNCells(); p ++)
+    {
+        m_Cells[p].fetch_or(values[p], std::memory_order_relaxed);
+    }
+    m_NMines = nMines;
+    m_StartTime.store(now());
+    m_State.store(BasicBoard<T>::PLAYING);
+}
+
+template <typename T>
+void BasicConcurrentBoard<T>::open(Pos p)
+{
+    if (p == POS_UNDEFINED || getState(p) == Cell::FLAGGED
+        || getState(p) == Cell::UNKNOWN)
+    {
+        return;
+    }
+    std::call_once(m_InitFlag, [&] { initCellValues(p); });
+    if (m_State.load() != BasicBoard<T>::PLAYING)
+    {
+        return;
+    }
+
+    // Whoever reveals a cell continues the fill from it. Only the clicked
+    // cell must be hidden, the fill also opens question marks as in
+    // BasicBoard.
+    std::vector<Pos> stack;
+    if (getState(p) == Cell::SHOWN || reveal(p, false))
+    {
+        expand(p, stack);
+    }
+    while (!stack.empty() && m_State.load() == BasicBoard<T>::PLAYING)
+    {
+        Pos q = stack.back();
+        stack.pop_back();
+        if (reveal(q, true))
+        {
+            expand(q, stack);
+        }
+    }
+}
+
+template <typename T>
+bool BasicConcurrentBoard<T>::reveal(Pos p, bool fromUnknown)
+{
+    uint8_t cell = m_Cells[p].load(std::memory_order_acquire);
+    typename Cell::Value value = cell & 0xF;
+    auto canReveal = [&](uint8_t c) {
+        typename Cell::State state = static_cast<typename Cell::State>(c >> 4);
+        return state == Cell::HIDDEN
+            || (fromUnknown && state == Cell::UNKNOWN);
+    };
+
+    if (!canReveal(cell))
+    {
+        return false;
+    }
+
+    if (value == Cell::MINE)
+    {
+        // The game is lost before the mine shows, so that a win counted
+        // concurrently can not also stand. The mine may be flagged in the
+        // meantime; the flag then stays and keeps its count.
+        State playing = BasicBoard<T>::PLAYING;
+        if (!m_State.compare_exchange_strong(playing, BasicBoard<T>::LOST))
+        {
+            return false;
+        }
+        m_StopTime.store(now());
+        while (!m_Cells[p].compare_exchange_weak(cell,
+            pack(Cell::SHOWN, value), std::memory_order_acq_rel))
+        {
+            if (!canReveal(cell))
+            {
+                return false;
+            }
+        }
+        m_NHidden.fetch_sub(1);
+        return false;
+    }
+
+    while (!m_Cells[p].compare_exchange_weak(cell, pack(Cell::SHOWN, value),
+        std::memory_order_acq_rel))
+    {
+        if (!canReveal(cell))
+        {
+            return false;
+        }
+    }
+
+    // Only safe cells count down while playing, so reaching the number of
+    // mines means every safe cell is shown
+    if (m_NHidden.fetch_sub(1) - 1 == m_NMines.load())
+    {
+        finish(BasicBoard<T>::WON);
+    }
+    return true;
+}
+
+template <typename T>
+void BasicConcurrentBoard<T>::expand(Pos p, std::vector<Pos> &stack) const
+{
+    Dims dims = getDims();
+    typename Cell::Value nMineFound = 0;
+    forEachNeighbor<Topology>(dims, p, [&](Pos np) {
+        if (getState(np) == Cell::FLAGGED)
+        {
+            nMineFound ++;
+        }
+    });
+
+    if (nMineFound >= getValue(p))
+    {
+        forEachNeighbor<Topology>(dims, p, [&](Pos np) {
+            typename Cell::State state = getState(np);
+            if (state != Cell::SHOWN && state != Cell::FLAGGED)
+            {
+                stack.push_back(np);
+            }
+        });
+    }
+}
+
+template <typename T>
+void BasicConcurrentBoard<T>::finish(State state)
+{
+    State playing = BasicBoard<T>::PLAYING;
+    if (m_State.compare_exchange_strong(playing, state))
+    {
+        m_StopTime.store(now());
+    }
+}
+
+template <typename T>
+void BasicConcurrentBoard<T>::nextState(Pos p)
+{
+    if (p == POS_UNDEFINED)
+    {
+        return;
+    }
+
+    uint8_t cell = m_Cells[p].load(std::memory_order_acquire);
+    uint8_t next = 0;
+    do
+    {
+        typename Cell::Value value = cell & 0xF;
+        switch (static_cast<typename Cell::State>(cell >> 4))
+        {
+            case Cell::HIDDEN:
+                next = pack(Cell::FLAGGED, value);
+                break;
+            case Cell::FLAGGED:
+                next = pack(Cell::UNKNOWN, value);
+                break;
+            case Cell::UNKNOWN:
+                next = pack(Cell::HIDDEN, value);
+                break;
+            default:
+                return;
+        }
+    }
+    while (!m_Cells[p].compare_exchange_weak(cell, next,
+        std::memory_order_acq_rel));
+
+    if (next >> 4 == Cell::FLAGGED)
+    {
+        m_NFlagged.fetch_add(1);
+    }
+    else if (next >> 4 == Cell::UNKNOWN)
+    {
+        m_NFlagged.fetch_sub(1);
+    }
+}
+
+template <typename T>
+typename BasicConcurrentBoard<T>::Size
+BasicConcurrentBoard<T>::getNMinesRemaining() const
+{
+    if (isWon())
+    {
+        return 0;
+    }
+    Size nMines = m_NMines.load();
+    Size nFlagged = m_NFlagged.load();
+    return nMines > nFlagged ? nMines - nFlagged : 0;
+}
+
+template <typename T>
+Timer::Sec BasicConcurrentBoard<T>::getElapsedSec() const
+{
+    int64_t start = m_StartTime.load();
+    if (start == 0)
+    {
+        return 0;
+    }
+    int64_t stop = m_StopTime.load();
+    return static_cast<Timer::Sec>(((stop != 0 ? stop : now()) - start)
+        / 1000000000);
+}
+
+template class BasicConcurrentBoard<SquareTopology>;
+template class BasicConcurrentBoard<TorusTopology>;
+template class BasicConcurrentBoard<HexTopology>;
+template class BasicConcurrentBoard<CubeTopology>;
@@ -0,0 +1,124 @@
+#ifndef CANH_CONCURRENT_BOARD_H
+#define CANH_CONCURRENT_BOARD_H
+
+#include "board.h"
+#include "timer.h"
+#include "topology.h"
+#include "util.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// A board that any number of threads may open and flag at the same time,
+// e.g. solver agents working on different regions. Every cell is one atomic
+// byte packed as state << 4 | value, and every transition is a
+// compare-and-swap, so there is no lock on the hot path: a thread owns the
+// cells it reveals and expands the flood fill from them, wherever the fill
+// goes. Counters are atomic and the game ends through a single CAS on the
+// game state, so exactly one thread wins or loses the game.
+//
+// Undo, redo and hashing are left to the single-threaded BasicBoard.
+template <typename TopologyT>
+class BasicConcurrentBoard
+{
+public:
+    typedef TopologyT Topology;
+    typedef int32_t Pos;
+    typedef uint32_t Size;
+    typedef typename BasicBoard<TopologyT>::Seed Seed;
+    typedef typename BasicBoard<TopologyT>::Cell Cell;
+    typedef typename BasicBoard<TopologyT>::State State;
+
+    static const Pos POS_UNDEFINED = -1;
+
+    // The mines are placed as BasicBoard places them for the same seed and
+    // first opened cell
+    BasicConcurrentBoard(Size nRows, Size nCols, Size nMines,
+        Size nLayers = 1, Seed seed = Util::getRNG()());
+
+    typename Cell::State getState(Pos p) const
+    {
+        return static_cast<typename Cell::State>(
+            m_Cells[p].load(std::memory_order_acquire) >> 4);
+    }
+    typename Cell::Value getValue(Pos p) const
+    {
+        return m_Cells[p].load(std::memory_order_acquire) & 0xF;
+    }
+
+    State getGameState() const { return m_State.load(); }
+    bool isWon() const { return m_State.load() == BasicBoard<TopologyT>::WON; }
+    bool isLost() const
+    {
+        return m_State.load() == BasicBoard<TopologyT>::LOST;
+    }
+
+    Size getNLayers() const { return m_NLayers; }
+    Size getNRows() const { return m_NRows; }
+    Size getNCols() const { return m_NCols; }
+    Size getNMines() const { return m_NMines.load(); }
+    Size getNCells() const { return m_NLayers * m_NRows * m_NCols; }
+    Dims getDims() const
+    {
+        return {static_cast<int>(m_NLayers), static_cast<int>(m_NRows),
+            static_cast<int>(m_NCols)};
+    }
+
+    Size getNHidden() const { return m_NHidden.load(); }
+    Size getNFlagged() const { return m_NFlagged.load(); }
+    Size getNMinesRemaining() const;
+
+    Seed getSeed() const { return m_Seed; }
+
+    Timer::Sec getElapsedSec() const;
+
+    Pos convertPos(Pos r, Pos c, Pos l = 0) const
+    {
+        return (l * m_NRows + r) * m_NCols + c;
+    }
+
+    // Same rules as BasicBoard: opening a shown cell whose flags are all
+    // placed opens its other neighbours. The first open places the mines,
+    // and any thread opening at the same time waits for it.
+    void open(Pos p);
+    void nextState(Pos p);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    std::atomic<State> m_State;
+    Size m_NLayers;
+    Size m_NRows;
+    Size m_NCols;
+    std::atomic<Size> m_NMines;
+    std::atomic<Size> m_NHidden;
+    std::atomic<Size> m_NFlagged;
+    Seed m_Seed;
+    std::once_flag m_InitFlag;
+
+    // Nanoseconds on Clock, zero while not started or not stopped
+    std::atomic<int64_t> m_StartTime;
+    std::atomic<int64_t> m_StopTime;
+
+    std::unique_ptr<std::atomic<uint8_t>[]> m_Cells;
+
+    static uint8_t pack(typename Cell::State state, typename Cell::Value value)
+    {
+        return static_cast<uint8_t>(state << 4 | value);
+    }
+    static int64_t now();
+
+    void initCellValues(Pos safePos);
+    bool reveal(Pos p, bool fromUnknown);
+    void expand(Pos p, std::vector<Pos> &stack) const;
+    void finish(State state);
+};
+
+typedef BasicConcurrentBoard<CANH_TOPOLOGY> ConcurrentBoard;
+
+#endif
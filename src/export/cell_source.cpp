@@ -0,0 +1,39 @@
+#include "cell_source.h"
+#include "board.h"
+#include "infinite_board.h"
+
+void BoardSource::readRow(Coord r, Coord c, Coord n, uint8_t *cells) const
+{
+    Board::Pos p = m_Board.convertPos(r % m_Board.getNRows(), c,
+        r / m_Board.getNRows());
+    for (Coord i = 0; i < n; i ++, p ++)
+    {
+        cells[i] = static_cast<uint8_t>(
+            m_Board.getState(p) << 4 | m_Board.getValue(p));
+    }
+}
+
+void InfiniteBoardSource::readRow(Coord r, Coord c, Coord n,
+    uint8_t *cells) const
+{
+    InfiniteBoard::Coord y = m_Top + r;
+    bool lost = m_Board.isLost();
+    for (Coord i = 0; i < n; i ++)
+    {
+        InfiniteBoard::Coord x = m_Left + c + i;
+        Board::Cell::State state = m_Board.getState(y, x);
+
+        // Hidden values only matter for showing the mines of a lost game,
+        // and computing them for every cell of a large window is not free.
+        Board::Cell::Value value = 0;
+        if (state == Board::Cell::SHOWN)
+        {
+            value = m_Board.getValue(y, x);
+        }
+        else if (lost && m_Board.isMine(y, x))
+        {
+            value = Board::Cell::MINE;
+        }
+        cells[i] = static_cast<uint8_t>(state << 4 | value);
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef CANH_CELL_SOURCE_H
+#define CANH_CELL_SOURCE_H
+
+#include "board.h"
+#include "infinite_board.h"
+
+#include <cstdint>
+
+// A rectangular grid of cells to render. Cells are packed as in
+// GameLogic::Snapshot (state << 4 | value) so they can go straight through
+// SpriteAtlas::translateRow. readRow may be called from several threads at
+// once, as long as the underlying board is not modified meanwhile.
+class CellSource
+{
+public:
+    typedef int32_t Coord;
+
+    virtual ~CellSource() {}
+
+    virtual Coord getNRows() const = 0;
+    virtual Coord getNCols() const = 0;
+    virtual Board::State getGameState() const = 0;
+
+    virtual void readRow(Coord r, Coord c, Coord n, uint8_t *cells) const = 0;
+};
+
+// A whole Board, with its layers stacked vertically
+class BoardSource : public CellSource
+{
+public:
+    explicit BoardSource(const Board &board) : m_Board(board) {}
+
+    Coord getNRows() const override
+    {
+        return m_Board.getNLayers() * m_Board.getNRows();
+    }
+    Coord getNCols() const override { return m_Board.getNCols(); }
+    Board::State getGameState() const override
+    {
+        return m_Board.getGameState();
+    }
+
+    void readRow(Coord r, Coord c, Coord n, uint8_t *cells) const override;
+
+private:
+    const Board &m_Board;
+};
+
+// A window of an InfiniteBoard
+class InfiniteBoardSource : public CellSource
+{
+public:
+    InfiniteBoardSource(const InfiniteBoard &board, InfiniteBoard::Coord top,
+        InfiniteBoard::Coord left, Coord nRows, Coord nCols)
+        : m_Board(board), m_Top(top), m_Left(left), m_NRows(nRows),
+        m_NCols(nCols)
+    {
+    }
+
+    Coord getNRows() const override { return m_NRows; }
+    Coord getNCols() const override { return m_NCols; }
+    Board::State getGameState() const override
+    {
+        return m_Board.isLost() ? Board::LOST : Board::PLAYING;
+    }
+
+    void readRow(Coord r, Coord c, Coord n, uint8_t *cells) const override;
+
+private:
+    const InfiniteBoard &m_Board;
+    InfiniteBoard::Coord m_Top;
+    InfiniteBoard::Coord m_Left;
+    Coord m_NRows;
+    Coord m_NCols;
+};
+
+#endif
@@ -0,0 +1,165 @@
+#include "cell_source.h"
+#include "png_writer.h"
+#include "tile_renderer.h"
+#include "board.h"
+#include "infinite_board.h"
+#include "move_log.h"
+#include "util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Renders a board to PNG without opening a window. With --game it is a game
+// played with ./minesweeper --moves, finished or not, rebuilt from its move
+// log. Otherwise a synthetic board is made up, which is how the exporter is
+// benchmarked: a Board opened in the middle, or, with --infinite, a window
+// of an InfiniteBoard around its first click, up to 10k x 10k and beyond.
+int main(int argc, char *argv[])
+{
+    std::string output;
+    std::string game;
+    long nRows = 16;
+    long nCols = 30;
+    long nMines = 99;
+    bool infinite = false;
+    double density = 0.0;
+    InfiniteBoard::Seed seed = Util::getRNG()();
+    unsigned nThreads = std::max(1u, std::thread::hardware_concurrency());
+    int level = 6;
+
+    for (int i = 1; i < argc; i ++)
+    {
+        std::string arg = argv[i];
+        if (arg[0] != '-' && output.empty())
+        {
+            output = arg;
+            continue;
+        }
+        if (i + 1 == argc)
+        {
+            output.clear();
+            break;
+        }
+
+        const char *value = argv[++ i];
+        if (arg == "--game")
+        {
+            game = value;
+        }
+        else if (arg == "--rows")
+        {
+            nRows = std::atol(value);
+        }
+        else if (arg == "--cols")
+        {
+            nCols = std::atol(value);
+        }
+        else if (arg == "--mines")
+        {
+            nMines = std::atol(value);
+        }
+        else if (arg == "--infinite")
+        {
+            infinite = true;
+            density = std::atof(value);
+        }
+        else if (arg == "--seed")
+        {
+            seed = std::strtoull(value, nullptr, 10);
+        }
+        else if (arg == "--threads")
+        {
+            nThreads = std::atoi(value);
+        }
+        else if (arg == "--level")
+        {
+            level = std::atoi(value);
+        }
+        else
+        {
+            output.clear();
+            break;
+        }
+    }
+
+    if (output.empty() || (!game.empty() && infinite) || nRows <= 0
+        || nCols <= 0
+        || (infinite && !(InfiniteBoard::MIN_DENSITY <= density
+            && density < 1.0))
+        || (!infinite && (nRows * nCols > Board::MAX_N_CELLS
+            || nMines < 0 || nMines >= nRows * nCols)))
+    {
+        std::cerr << "Usage: " << argv[0] << " OUTPUT.png --game MOVES"
+                  << " [--threads N] [--level 0-9]" << std::endl
+                  << "       " << argv[0] << " OUTPUT.png"
+                  << " [--rows N] [--cols N] [--mines N]"
+                  << " [--infinite DENSITY] [--seed S]"
+                  << " [--threads N] [--level 0-9]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::unique_ptr<Board> board;
+    std::unique_ptr<InfiniteBoard> infiniteBoard;
+    std::unique_ptr<CellSource> source;
+    if (!game.empty())
+    {
+        try
+        {
+            board = MoveLog::replay(game);
+        }
+        catch (MoveLog::Exception &e)
+        {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        source = std::make_unique<BoardSource>(*board);
+    }
+    else if (infinite)
+    {
+        infiniteBoard = std::make_unique<InfiniteBoard>(density, seed);
+        infiniteBoard->open(0, 0);
+        source = std::make_unique<InfiniteBoardSource>(*infiniteBoard,
+            -nRows / 2, -nCols / 2, nRows, nCols);
+    }
+    else
+    {
+        board = std::make_unique<Board>(nRows, nCols, nMines, 1, seed);
+        board->open(board->convertPos(nRows / 2, nCols / 2));
+        source = std::make_unique<BoardSource>(*board);
+    }
+
+    std::ofstream out(output, std::ios::binary);
+    if (!out)
+    {
+        std::cerr << "Can not open \"" << output << "\"!" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        TileRenderer renderer(*source, nThreads);
+        PngWriter writer(out, renderer.getWidth(), renderer.getHeight(),
+            level);
+        renderer.render(writer);
+        writer.finish();
+
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        std::cout << renderer.getWidth() << "x" << renderer.getHeight()
+                  << " pixels in " << ms << " ms" << std::endl;
+    }
+    catch (PngWriter::Exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,127 @@
+#include "png_writer.h"
+
+#include <zlib.h>
+
+namespace
+{
+    void putU32(uint8_t *p, uint32_t x)
+    {
+        p[0] = static_cast<uint8_t>(x >> 24);
+        p[1] = static_cast<uint8_t>(x >> 16);
+        p[2] = static_cast<uint8_t>(x >> 8);
+        p[3] = static_cast<uint8_t>(x);
+    }
+}
+
+PngWriter::PngWriter(std::ostream &out, uint32_t width, uint32_t height,
+    int level)
+    : m_Out(out),
+    m_Width(width),
+    m_Height(height),
+    m_NRows(0),
+    m_Stream(),
+    m_Buffer(CHUNK_SIZE)
+{
+    if (deflateInit(&m_Stream, level) != Z_OK)
+    {
+        throw Exception("Can not initialize zlib!");
+    }
+    m_Stream.next_out = m_Buffer.data();
+    m_Stream.avail_out = static_cast<uInt>(CHUNK_SIZE);
+
+    static const uint8_t SIGNATURE[] = {
+        0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'
+    };
+    m_Out.write(reinterpret_cast<const char *>(SIGNATURE), sizeof(SIGNATURE));
+
+    // 8-bit truecolor, default compression and filtering, not interlaced
+    uint8_t header[13] = {};
+    putU32(header, width);
+    putU32(header + 4, height);
+    header[8] = 8;
+    header[9] = 2;
+    writeChunk("IHDR", header, sizeof(header));
+}
+
+PngWriter::~PngWriter()
+{
+    deflateEnd(&m_Stream);
+}
+
+void PngWriter::writeRow(const uint8_t *rgb)
+{
+    // Every row starts with its filter type; sprites repeat enough for
+    // deflate to do well without filtering.
+    static const uint8_t FILTER_NONE = 0;
+    compress(&FILTER_NONE, 1, Z_NO_FLUSH);
+    compress(rgb, static_cast<size_t>(m_Width) * 3, Z_NO_FLUSH);
+    m_NRows ++;
+}
+
+void PngWriter::finish()
+{
+    if (m_NRows != m_Height)
+    {
+        throw Exception("Image has " + std::to_string(m_NRows)
+            + " rows instead of " + std::to_string(m_Height) + "!");
+    }
+    compress(nullptr, 0, Z_FINISH);
+    writeChunk("IEND", nullptr, 0);
+    m_Out.flush();
+    if (!m_Out)
+    {
+        throw Exception("Can not write image!");
+    }
+}
+
+void PngWriter::compress(const uint8_t *data, size_t n, int flush)
+{
+    m_Stream.next_in = const_cast<Bytef *>(data);
+    m_Stream.avail_in = static_cast<uInt>(n);
+
+    int status = Z_OK;
+    do
+    {
+        if (m_Stream.avail_out == 0)
+        {
+            writeChunk("IDAT", m_Buffer.data(), CHUNK_SIZE);
+            m_Stream.next_out = m_Buffer.data();
+            m_Stream.avail_out = static_cast<uInt>(CHUNK_SIZE);
+        }
+
+        status = deflate(&m_Stream, flush);
+        if (status == Z_STREAM_ERROR)
+        {
+            throw Exception("Can not compress image!");
+        }
+    }
+    while (m_Stream.avail_in > 0
+        || (flush == Z_FINISH && status != Z_STREAM_END));
+
+    if (flush == Z_FINISH)
+    {
+        writeChunk("IDAT", m_Buffer.data(), CHUNK_SIZE - m_Stream.avail_out);
+    }
+}
+
+void PngWriter::writeChunk(const char *type, const uint8_t *data, size_t n)
+{
+    uint8_t head[8];
+    putU32(head, static_cast<uint32_t>(n));
+    head[4] = type[0];
+    head[5] = type[1];
+    head[6] = type[2];
+    head[7] = type[3];
+
+    uLong crc = crc32(0, head + 4, 4);
+    if (n > 0)
+    {
+        crc = crc32(crc, data, static_cast<uInt>(n));
+    }
+    uint8_t tail[4];
+    putU32(tail, static_cast<uint32_t>(crc));
+
+    m_Out.write(reinterpret_cast<const char *>(head), sizeof(head));
+    m_Out.write(reinterpret_cast<const char *>(data), n);
+    m_Out.write(reinterpret_cast<const char *>(tail), sizeof(tail));
+}
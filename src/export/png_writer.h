@@ -0,0 +1,49 @@
+#ifndef CANH_PNG_WRITER_H
+#define CANH_PNG_WRITER_H
+
+#include <zlib.h>
+
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Writes an 8-bit RGB PNG one row at a time. Rows are deflated as they
+// arrive and flushed in IDAT chunks, so memory use does not depend on the
+// image height.
+class PngWriter
+{
+public:
+    class Exception : public std::runtime_error
+    {
+    public:
+        Exception(const std::string &msg) : std::runtime_error(msg) {}
+    };
+
+    PngWriter(std::ostream &out, uint32_t width, uint32_t height,
+        int level = Z_DEFAULT_COMPRESSION);
+    ~PngWriter();
+
+    // Takes width * 3 bytes
+    void writeRow(const uint8_t *rgb);
+
+    // Must be called once all rows are written
+    void finish();
+
+private:
+    static const size_t CHUNK_SIZE = 1 << 16;
+
+    std::ostream &m_Out;
+    uint32_t m_Width;
+    uint32_t m_Height;
+    uint32_t m_NRows;
+    z_stream m_Stream;
+    std::vector<uint8_t> m_Buffer;
+
+    void compress(const uint8_t *data, size_t n, int flush);
+    void writeChunk(const char *type, const uint8_t *data, size_t n);
+};
+
+#endif
@@ -0,0 +1,189 @@
+#include "tile_renderer.h"
+#include "cell_source.h"
+#include "png_writer.h"
+#include "sprite_atlas.h"
+
+#include <algorithm>
+#include <cstring>
+
+const TileRenderer::Coord TileRenderer::BAND_ROWS;
+const TileRenderer::Coord TileRenderer::TILE_COLS;
+
+TileRenderer::TileRenderer(const CellSource &source, unsigned nThreads)
+    : m_Source(source),
+    m_GameState(source.getGameState()),
+    m_NTileCols((source.getNCols() + TILE_COLS - 1) / TILE_COLS),
+    m_CellPixels(N_CELL_SPRITES * CELL_BYTES),
+    m_Generation(0),
+    m_NFinished(0),
+    m_Quit(false),
+    m_Band(),
+    m_NextTile(0)
+{
+    for (size_t s = 0; s < N_CELL_SPRITES; s ++)
+    {
+        const SpriteAtlas::Rect &rect = SpriteAtlas::RECTS[s];
+        uint8_t *dst = &m_CellPixels[s * CELL_BYTES];
+        for (SpriteAtlas::Size y = 0; y < rect.h; y ++)
+        {
+            const uint8_t *src = SpriteAtlas::PIXELS
+                + ((rect.y + y) * SpriteAtlas::IMAGE_W + rect.x) * 4;
+            for (SpriteAtlas::Size x = 0; x < rect.w; x ++, src += 4)
+            {
+                *dst ++ = src[0];
+                *dst ++ = src[1];
+                *dst ++ = src[2];
+            }
+        }
+    }
+
+    for (unsigned i = 0; i < std::max(1u, nThreads); i ++)
+    {
+        m_Threads.emplace_back(&TileRenderer::work, this);
+    }
+}
+
+TileRenderer::~TileRenderer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Quit = true;
+    }
+    m_WorkReady.notify_all();
+    for (std::thread &thread : m_Threads)
+    {
+        thread.join();
+    }
+}
+
+uint32_t TileRenderer::getWidth() const
+{
+    return static_cast<uint32_t>(m_Source.getNCols()) * SpriteAtlas::CELL_W;
+}
+
+uint32_t TileRenderer::getHeight() const
+{
+    return static_cast<uint32_t>(m_Source.getNRows()) * SpriteAtlas::CELL_H;
+}
+
+void TileRenderer::render(PngWriter &writer)
+{
+    size_t rowBytes = static_cast<size_t>(getWidth()) * 3;
+    size_t bandBytes = rowBytes * BAND_ROWS * SpriteAtlas::CELL_H;
+    std::vector<uint8_t> buffers[2] = {
+        std::vector<uint8_t>(bandBytes), std::vector<uint8_t>(bandBytes)
+    };
+
+    Coord nRows = m_Source.getNRows();
+    Coord nBands = (nRows + BAND_ROWS - 1) / BAND_ROWS;
+    auto getBand = [&](Coord b) {
+        Band band = {b * BAND_ROWS, std::min(BAND_ROWS, nRows - b * BAND_ROWS),
+            buffers[b % 2].data()};
+        return band;
+    };
+
+    if (nBands > 0)
+    {
+        startBand(getBand(0));
+        waitBand();
+    }
+    for (Coord b = 0; b < nBands; b ++)
+    {
+        // Rasterize the next band while this one is being compressed
+        if (b + 1 < nBands)
+        {
+            startBand(getBand(b + 1));
+        }
+
+        Band band = getBand(b);
+        for (Coord y = 0; y < band.nRows * SpriteAtlas::CELL_H; y ++)
+        {
+            writer.writeRow(band.pixels + y * rowBytes);
+        }
+
+        if (b + 1 < nBands)
+        {
+            waitBand();
+        }
+    }
+}
+
+void TileRenderer::work()
+{
+    uint64_t generation = 0;
+    while (true)
+    {
+        Band band;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_WorkReady.wait(lock, [&] {
+                return m_Quit || m_Generation != generation;
+            });
+            if (m_Quit)
+            {
+                return;
+            }
+            generation = m_Generation;
+            band = m_Band;
+        }
+
+        size_t nTiles = static_cast<size_t>(band.nRows) * m_NTileCols;
+        size_t tile = 0;
+        while ((tile = m_NextTile.fetch_add(1)) < nTiles)
+        {
+            drawTile(band, tile);
+        }
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (++ m_NFinished == m_Threads.size())
+        {
+            m_WorkDone.notify_one();
+        }
+    }
+}
+
+void TileRenderer::startBand(const Band &band)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Band = band;
+        m_NextTile = 0;
+        m_NFinished = 0;
+        m_Generation ++;
+    }
+    m_WorkReady.notify_all();
+}
+
+void TileRenderer::waitBand()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_WorkDone.wait(lock, [&] { return m_NFinished == m_Threads.size(); });
+}
+
+void TileRenderer::drawTile(const Band &band, size_t tile) const
+{
+    // A tile is a run of up to TILE_COLS cells within one cell row
+    Coord row = static_cast<Coord>(tile / m_NTileCols);
+    Coord col = static_cast<Coord>(tile % m_NTileCols) * TILE_COLS;
+    Coord n = std::min(TILE_COLS, m_Source.getNCols() - col);
+
+    uint8_t cells[TILE_COLS];
+    uint8_t sprites[TILE_COLS];
+    m_Source.readRow(band.firstRow + row, col, n, cells);
+    SpriteAtlas::translateRow(m_GameState, cells, n, sprites);
+
+    size_t rowBytes = static_cast<size_t>(getWidth()) * 3;
+    size_t spriteRowBytes = SpriteAtlas::CELL_W * 3;
+    uint8_t *dst = band.pixels + row * SpriteAtlas::CELL_H * rowBytes
+        + col * spriteRowBytes;
+    for (SpriteAtlas::Size y = 0; y < SpriteAtlas::CELL_H; y ++)
+    {
+        uint8_t *out = dst + y * rowBytes;
+        for (Coord i = 0; i < n; i ++, out += spriteRowBytes)
+        {
+            std::memcpy(out,
+                &m_CellPixels[sprites[i] * CELL_BYTES + y * spriteRowBytes],
+                spriteRowBytes);
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef CANH_TILE_RENDERER_H
+#define CANH_TILE_RENDERER_H
+
+#include "cell_source.h"
+#include "png_writer.h"
+#include "sprite_atlas.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Draws a CellSource with the sprite atlas into an RGB image without any
+// window. The image is produced in bands of a few cell rows: each band is
+// cut into tiles that a pool of threads rasterizes, while the calling thread
+// encodes the previous band. Only two bands are held in memory at a time.
+class TileRenderer
+{
+public:
+    TileRenderer(const CellSource &source, unsigned nThreads);
+    ~TileRenderer();
+
+    uint32_t getWidth() const;
+    uint32_t getHeight() const;
+
+    void render(PngWriter &writer);
+
+private:
+    typedef CellSource::Coord Coord;
+
+    static const Coord BAND_ROWS = 4;
+    static const Coord TILE_COLS = 256;
+    static const size_t N_CELL_SPRITES = SpriteAtlas::CELL_UNOPENED + 1;
+    static const size_t CELL_BYTES =
+        SpriteAtlas::CELL_W * SpriteAtlas::CELL_H * 3;
+
+    struct Band
+    {
+        Coord firstRow;
+        Coord nRows;
+        uint8_t *pixels;
+    };
+
+    const CellSource &m_Source;
+    Board::State m_GameState;
+    Coord m_NTileCols;
+
+    // RGB pixels of every cell sprite, one sprite after another
+    std::vector<uint8_t> m_CellPixels;
+
+    std::vector<std::thread> m_Threads;
+    std::mutex m_Mutex;
+    std::condition_variable m_WorkReady;
+    std::condition_variable m_WorkDone;
+    uint64_t m_Generation;
+    unsigned m_NFinished;
+    bool m_Quit;
+    Band m_Band;
+    std::atomic<size_t> m_NextTile;
+
+    void work();
+    void startBand(const Band &band);
+    void waitBand();
+    void drawTile(const Band &band, size_t tile) const;
+};
+
+#endif
@@ -0,0 +1,164 @@
+#include "game_logic.h"
+#include "board.h"
+
+#include <chrono>
+#include <thread>
+
+namespace
+{
+    // While the clock runs the logic thread wakes this often to publish a
+    // new second, so the shown time lags by at most this much
+    const std::chrono::milliseconds CLOCK_TICK(50);
+}
+
+GameLogic::GameLogic(Board::Size nRows, Board::Size nCols, Board::Size nMines,
+    Board::Size nLayers, const std::string &statsPath,
+    const std::string &movesPath)
+    : m_NRows(nRows),
+    m_NCols(nCols),
+    m_NMines(nMines),
+    m_NLayers(nLayers),
+    m_Board(new Board(nRows, nCols, nMines, nLayers)),
+    m_Version(0),
+    m_Stats(statsPath.empty() ? nullptr : new GameStatsWriter(statsPath)),
+    m_Recorded(false),
+    m_Moves(movesPath.empty() ? nullptr : new MoveLog(movesPath)),
+    m_Quit(false)
+{
+    if (m_Moves != nullptr)
+    {
+        m_Moves->start(*m_Board);
+    }
+
+    // Make the first frame available before the thread starts
+    publish();
+    m_Thread = std::thread(&GameLogic::loop, this);
+}
+
+GameLogic::~GameLogic()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_WakeMutex);
+        m_Quit = true;
+    }
+    m_Wake.notify_one();
+    m_Thread.join();
+}
+
+bool GameLogic::push(const Command &command)
+{
+    if (!m_Commands.push(command))
+    {
+        return false;
+    }
+
+    // The logic thread checks for commands under the lock before it sleeps,
+    // so taking it here keeps the wakeup from falling in between
+    std::lock_guard<std::mutex> lock(m_WakeMutex);
+    m_Wake.notify_one();
+    return true;
+}
+
+void GameLogic::loop()
+{
+    Timer::Sec lastSec = m_Board->getElapsedSec();
+
+    while (!m_Quit)
+    {
+        bool changed = false;
+        Command command;
+        while (m_Commands.pop(command))
+        {
+            execute(command);
+            changed = true;
+        }
+
+        Timer::Sec sec = m_Board->getElapsedSec();
+        if (changed || sec != lastSec)
+        {
+            lastSec = sec;
+            publish();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_WakeMutex);
+        auto ready = [this] { return m_Quit || !m_Commands.empty(); };
+        if (m_Board->getGameState() == Board::PLAYING)
+        {
+            m_Wake.wait_for(lock, CLOCK_TICK, ready);
+        }
+        else
+        {
+            m_Wake.wait(lock, ready);
+        }
+    }
+}
+
+void GameLogic::execute(const Command &command)
+{
+    switch (command.type)
+    {
+        case Command::OPEN:
+            m_Board->open(command.pos);
+            logMove(MoveLog::OPEN, command.pos);
+            break;
+        case Command::NEXT_STATE:
+            m_Board->nextState(command.pos);
+            logMove(MoveLog::NEXT_STATE, command.pos);
+            break;
+        case Command::UNDO:
+            m_Board->undo();
+            logMove(MoveLog::UNDO);
+            break;
+        case Command::REDO:
+            m_Board->redo();
+            logMove(MoveLog::REDO);
+            break;
+        case Command::RESET:
+            m_Board.reset(new Board(m_NRows, m_NCols, m_NMines, m_NLayers));
+            m_Recorded = false;
+            if (m_Moves != nullptr)
+            {
+                m_Moves->start(*m_Board);
+            }
+            break;
+    }
+
+    // Only the first outcome counts, undoing a loss and playing on does not
+    // make another game
+    if (m_Stats != nullptr && !m_Recorded
+        && (m_Board->isWon() || m_Board->isLost()))
+    {
+        m_Stats->append(GameRecord::fromBoard(*m_Board));
+        m_Recorded = true;
+    }
+}
+
+void GameLogic::logMove(MoveLog::Move move, Board::Pos p)
+{
+    // Clicks outside the board change nothing worth replaying
+    bool onBoard = p != Board::POS_UNDEFINED
+        || move == MoveLog::UNDO || move == MoveLog::REDO;
+    if (m_Moves != nullptr && onBoard)
+    {
+        m_Moves->append(move, p);
+    }
+}
+
+void GameLogic::publish()
+{
+    Snapshot &snapshot = m_Snapshots.getBack();
+    snapshot.version = ++ m_Version;
+    snapshot.state = m_Board->getGameState();
+    snapshot.dims = m_Board->getDims();
+    snapshot.nMinesRemaining = m_Board->getNMinesRemaining();
+    snapshot.elapsedSec = m_Board->getElapsedSec();
+
+    snapshot.cells.resize(m_Board->getNCells());
+    for (Board::Pos p = 0; p < m_Board->getNCells(); p ++)
+    {
+        snapshot.cells[p] = static_cast<uint8_t>(
+            m_Board->getState(p) << 4 | m_Board->getValue(p));
+    }
+    m_Snapshots.publish();
+}
@@ -0,0 +1,127 @@
+#ifndef CANH_GAME_LOGIC_H
+#define CANH_GAME_LOGIC_H
+
+#include "board.h"
+#include "game_stats.h"
+#include "move_log.h"
+#include "timer.h"
+#include "topology.h"
+#include "spsc_queue.h"
+#include "triple_buffer.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Runs a Board on its own thread. The UI thread sends commands through a
+// wait-free queue and reads immutable snapshots of the board through a triple
+// buffer, so drawing a frame never waits for game logic such as a large flood
+// fill. The logic thread sleeps until a command comes in, or while the clock
+// runs until the next second may show.
+class GameLogic
+{
+public:
+    struct Command
+    {
+        enum Type
+        {
+            OPEN,
+            NEXT_STATE,
+            UNDO,
+            REDO,
+            RESET
+        };
+
+        Type type;
+        Board::Pos pos;
+    };
+
+    // Everything needed to draw the board. Each cell is packed into a byte
+    // holding its state in the high nibble and its value in the low nibble.
+    struct Snapshot
+    {
+        uint64_t version;
+        Board::State state;
+        Dims dims;
+        Board::Size nMinesRemaining;
+        Timer::Sec elapsedSec;
+        std::vector<uint8_t> cells;
+
+        Board::Cell::State getState(Board::Pos p) const
+        {
+            return static_cast<Board::Cell::State>(cells[p] >> 4);
+        }
+        Board::Cell::Value getValue(Board::Pos p) const
+        {
+            return cells[p] & 0xF;
+        }
+
+        bool isWon() const { return state == Board::WON; }
+        bool isLost() const { return state == Board::LOST; }
+
+        Board::Pos getNCells() const
+        {
+            return static_cast<Board::Pos>(cells.size());
+        }
+        Board::Pos getLayer(Board::Pos p) const
+        {
+            return p / (dims.nRows * dims.nCols);
+        }
+        Board::Pos getRow(Board::Pos p) const
+        {
+            return p % (dims.nRows * dims.nCols) / dims.nCols;
+        }
+        Board::Pos getCol(Board::Pos p) const { return p % dims.nCols; }
+        Board::Pos convertPos(Board::Pos r, Board::Pos c, Board::Pos l) const
+        {
+            return (l * dims.nRows + r) * dims.nCols + c;
+        }
+    };
+
+    // Finished games are appended to the statistics file at statsPath, and
+    // the moves of the current game kept in a MoveLog at movesPath, for the
+    // paths that are given. Statistics are buffered and written a block at a
+    // time, the last one on destruction.
+    GameLogic(Board::Size nRows, Board::Size nCols, Board::Size nMines,
+        Board::Size nLayers, const std::string &statsPath = "",
+        const std::string &movesPath = "");
+    ~GameLogic();
+
+    // Returns false, without waiting, if the logic thread is too far behind
+    bool push(const Command &command);
+
+    // Latest published snapshot, valid until the next call
+    const Snapshot &getSnapshot() { return m_Snapshots.read(); }
+
+private:
+    static const size_t QUEUE_SIZE = 256;
+
+    Board::Size m_NRows;
+    Board::Size m_NCols;
+    Board::Size m_NMines;
+    Board::Size m_NLayers;
+    std::unique_ptr<Board> m_Board;
+    uint64_t m_Version;
+    std::unique_ptr<GameStatsWriter> m_Stats;
+    bool m_Recorded;    // the current game is in m_Stats, until RESET
+    std::unique_ptr<MoveLog> m_Moves;
+
+    SpscQueue<Command, QUEUE_SIZE> m_Commands;
+    TripleBuffer<Snapshot> m_Snapshots;
+    std::atomic<bool> m_Quit;
+    std::mutex m_WakeMutex;
+    std::condition_variable m_Wake;
+    std::thread m_Thread;
+
+    void loop();
+    void execute(const Command &command);
+    void logMove(MoveLog::Move move, Board::Pos p = Board::POS_UNDEFINED);
+    void publish();
+};
+
+#endif
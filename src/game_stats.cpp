@@ -0,0 +1,206 @@
+#include "game_stats.h"
+#include "board.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+const uint32_t GameStats::MAGIC;
+const size_t GameStats::COLUMN_SIZES[GameStats::N_COLUMNS] = {
+    8, 4, 4, 4, 2, 2, 2, 1
+};
+
+GameRecord GameRecord::fromBoard(const Board &board)
+{
+    GameRecord record;
+    record.seed = board.getSeed();
+    record.elapsedSec = board.getElapsedSec();
+    record.nClicks = board.getNClicks();
+    record.bv3 = board.get3BV();
+    record.nRows = board.getNRows();
+    record.nCols = board.getNCols() * board.getNLayers();
+    record.nMines = board.getNMines();
+    record.won = board.isWon() ? 1 : 0;
+    return record;
+}
+
+size_t GameStats::getBlockSize(uint32_t nRows)
+{
+    size_t size = sizeof(BlockHeader);
+    for (size_t c = 0; c < N_COLUMNS; c ++)
+    {
+        size += COLUMN_SIZES[c] * nRows;
+    }
+    return (size + 7) & ~static_cast<size_t>(7);
+}
+
+namespace
+{
+    template <typename T>
+    void appendColumn(std::vector<uint8_t> &block,
+        const std::vector<GameRecord> &records, T GameRecord::*field,
+        uint64_t &min, uint64_t &max)
+    {
+        size_t offset = block.size();
+        block.resize(offset + records.size() * sizeof(T));
+        T *values = reinterpret_cast<T *>(&block[offset]);
+
+        T lo = records[0].*field, hi = lo;
+        for (size_t i = 0; i < records.size(); i ++)
+        {
+            values[i] = records[i].*field;
+            lo = std::min(lo, values[i]);
+            hi = std::max(hi, values[i]);
+        }
+        min = lo;
+        max = hi;
+    }
+}
+
+GameStatsWriter::GameStatsWriter(const std::string &path, uint32_t blockRows)
+    : m_Out(path, std::ios::binary | std::ios::app),
+    m_BlockRows(std::max(1u, blockRows))
+{
+    if (!m_Out)
+    {
+        throw GameStats::Exception("Can not open \"" + path + "\"!");
+    }
+    m_Records.reserve(m_BlockRows);
+}
+
+GameStatsWriter::~GameStatsWriter()
+{
+    flush();
+}
+
+void GameStatsWriter::append(const GameRecord &record)
+{
+    m_Records.push_back(record);
+    if (m_Records.size() == m_BlockRows)
+    {
+        flush();
+    }
+}
+
+void GameStatsWriter::flush()
+{
+    if (m_Records.empty())
+    {
+        return;
+    }
+
+    GameStats::BlockHeader header = {};
+    header.magic = GameStats::MAGIC;
+    header.nRows = static_cast<uint32_t>(m_Records.size());
+
+    // Built in memory first: the header depends on the data, and a block
+    // is only ever written whole
+    std::vector<uint8_t> block(sizeof(header));
+    block.reserve(GameStats::getBlockSize(header.nRows));
+    appendColumn(block, m_Records, &GameRecord::seed,
+        header.min[GameStats::SEED], header.max[GameStats::SEED]);
+    appendColumn(block, m_Records, &GameRecord::elapsedSec,
+        header.min[GameStats::ELAPSED_SEC], header.max[GameStats::ELAPSED_SEC]);
+    appendColumn(block, m_Records, &GameRecord::nClicks,
+        header.min[GameStats::N_CLICKS], header.max[GameStats::N_CLICKS]);
+    appendColumn(block, m_Records, &GameRecord::bv3,
+        header.min[GameStats::BV3], header.max[GameStats::BV3]);
+    appendColumn(block, m_Records, &GameRecord::nRows,
+        header.min[GameStats::N_ROWS], header.max[GameStats::N_ROWS]);
+    appendColumn(block, m_Records, &GameRecord::nCols,
+        header.min[GameStats::N_COLS], header.max[GameStats::N_COLS]);
+    appendColumn(block, m_Records, &GameRecord::nMines,
+        header.min[GameStats::N_MINES], header.max[GameStats::N_MINES]);
+    appendColumn(block, m_Records, &GameRecord::won,
+        header.min[GameStats::WON], header.max[GameStats::WON]);
+    block.resize(GameStats::getBlockSize(header.nRows));
+    std::memcpy(block.data(), &header, sizeof(header));
+
+    m_Out.write(reinterpret_cast<const char *>(block.data()), block.size());
+    m_Out.flush();
+    m_Records.clear();
+}
+
+GameStatsReader::GameStatsReader(const std::string &path)
+    : m_Fd(-1),
+    m_Data(nullptr),
+    m_Size(0),
+    m_NRecords(0)
+{
+    m_Fd = open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (m_Fd < 0 || fstat(m_Fd, &st) != 0)
+    {
+        if (m_Fd >= 0)
+        {
+            close(m_Fd);
+        }
+        throw GameStats::Exception("Can not open \"" + path + "\"!");
+    }
+    m_Size = static_cast<size_t>(st.st_size);
+    if (m_Size == 0)
+    {
+        return;
+    }
+
+    void *data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, m_Fd, 0);
+    if (data == MAP_FAILED)
+    {
+        close(m_Fd);
+        throw GameStats::Exception("Can not map \"" + path + "\"!");
+    }
+    m_Data = static_cast<const uint8_t *>(data);
+    madvise(data, m_Size, MADV_SEQUENTIAL);
+
+    size_t offset = 0;
+    while (offset + sizeof(GameStats::BlockHeader) <= m_Size)
+    {
+        Block block;
+        block.header = reinterpret_cast<const GameStats::BlockHeader *>(
+            m_Data + offset);
+        uint32_t n = block.header->nRows;
+        size_t size = GameStats::getBlockSize(n);
+        if (block.header->magic != GameStats::MAGIC || offset + size > m_Size)
+        {
+            // A block cut short by a crash ends the readable part
+            break;
+        }
+
+        const uint8_t *p = m_Data + offset + sizeof(GameStats::BlockHeader);
+        block.seed = reinterpret_cast<const uint64_t *>(p);
+        p += 8 * n;
+        block.elapsedSec = reinterpret_cast<const uint32_t *>(p);
+        p += 4 * n;
+        block.nClicks = reinterpret_cast<const uint32_t *>(p);
+        p += 4 * n;
+        block.bv3 = reinterpret_cast<const uint32_t *>(p);
+        p += 4 * n;
+        block.nRows = reinterpret_cast<const uint16_t *>(p);
+        p += 2 * n;
+        block.nCols = reinterpret_cast<const uint16_t *>(p);
+        p += 2 * n;
+        block.nMines = reinterpret_cast<const uint16_t *>(p);
+        p += 2 * n;
+        block.won = p;
+
+        m_Blocks.push_back(block);
+        m_NRecords += n;
+        offset += size;
+    }
+}
+
+GameStatsReader::~GameStatsReader()
+{
+    if (m_Data != nullptr)
+    {
+        munmap(const_cast<uint8_t *>(m_Data), m_Size);
+    }
+    if (m_Fd >= 0)
+    {
+        close(m_Fd);
+    }
+}
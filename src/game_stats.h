@@ -0,0 +1,126 @@
+#ifndef CANH_GAME_STATS_H
+#define CANH_GAME_STATS_H
+
+#include "board.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Outcome of one finished game
+struct GameRecord
+{
+    uint64_t seed;
+    uint32_t elapsedSec;
+    uint32_t nClicks;
+    uint32_t bv3;
+    uint16_t nRows;
+    uint16_t nCols;
+    uint16_t nMines;
+    uint8_t won;
+
+    static GameRecord fromBoard(const Board &board);
+};
+
+// Game records are stored by column in an append-only file made of
+// independent blocks. Each block starts with its row count and the minimum
+// and maximum of every column, so a query can skip blocks that cannot match
+// without touching their data. Columns are laid out widest first and blocks
+// are padded to 8 bytes, so every column of a memory-mapped file is aligned
+// for its type.
+class GameStats
+{
+public:
+    class Exception : public std::runtime_error
+    {
+    public:
+        Exception(const std::string &msg) : std::runtime_error(msg) {}
+    };
+
+    enum Column
+    {
+        SEED,
+        ELAPSED_SEC,
+        N_CLICKS,
+        BV3,
+        N_ROWS,
+        N_COLS,
+        N_MINES,
+        WON,
+
+        N_COLUMNS
+    };
+
+    static const uint32_t MAGIC = 0x4B4C424D; // "MBLK"
+    static const size_t COLUMN_SIZES[N_COLUMNS];
+
+    // Every column is unsigned, so the bounds are too; signed ones would put
+    // seeds from 2^63 up before the others
+    struct BlockHeader
+    {
+        uint32_t magic;
+        uint32_t nRows;
+        uint64_t min[N_COLUMNS];
+        uint64_t max[N_COLUMNS];
+    };
+
+    // Bytes taken by a block of nRows rows, header and padding included
+    static size_t getBlockSize(uint32_t nRows);
+};
+
+// Buffers records and appends them to the file one block at a time
+class GameStatsWriter
+{
+public:
+    static const uint32_t DEFAULT_BLOCK_ROWS = 1 << 16;
+
+    explicit GameStatsWriter(const std::string &path,
+        uint32_t blockRows = DEFAULT_BLOCK_ROWS);
+    ~GameStatsWriter();
+
+    void append(const GameRecord &record);
+
+    // Writes the buffered records as a (possibly short) block
+    void flush();
+
+private:
+    std::ofstream m_Out;
+    uint32_t m_BlockRows;
+    std::vector<GameRecord> m_Records;
+};
+
+// Maps a statistics file into memory and walks its blocks
+class GameStatsReader
+{
+public:
+    struct Block
+    {
+        const GameStats::BlockHeader *header;
+        const uint64_t *seed;
+        const uint32_t *elapsedSec;
+        const uint32_t *nClicks;
+        const uint32_t *bv3;
+        const uint16_t *nRows;
+        const uint16_t *nCols;
+        const uint16_t *nMines;
+        const uint8_t *won;
+    };
+
+    explicit GameStatsReader(const std::string &path);
+    ~GameStatsReader();
+
+    const std::vector<Block> &getBlocks() const { return m_Blocks; }
+    uint64_t getNRecords() const { return m_NRecords; }
+
+private:
+    int m_Fd;
+    const uint8_t *m_Data;
+    size_t m_Size;
+    std::vector<Block> m_Blocks;
+    uint64_t m_NRecords;
+};
+
+#endif
@@ -0,0 +1,173 @@
+#include "game_view.h"
+#include "board.h"
+#include "game_logic.h"
+#include "renderer.h"
+#include "sprite_atlas.h"
+#include "util.h"
+
+#include <cstddef>
+
+GameView::GameView(Renderer &renderer, Board::Size nRows, Board::Size nCols,
+    Board::Size nMines, Board::Size nLayers, const std::string &statsPath,
+    const std::string &movesPath)
+    : m_Renderer(renderer),
+    m_Game(nRows, nCols, nMines, nLayers, statsPath, movesPath),
+    m_Snapshot(&m_Game.getSnapshot()),
+    m_LastDrawVersion(0),
+    m_LastDrawSec(0),
+    m_RedrawRequired(true),
+    m_PressedPos(Board::POS_UNDEFINED),
+    m_CellPressed(false),
+    m_EmojiPressed(false)
+{
+}
+
+void GameView::loop()
+{
+    while (true)
+    {
+        draw();
+
+        // Wait for the first event only, then drain the rest before drawing
+        Renderer::Input input;
+        int timeout = INPUT_TIMEOUT_MS;
+        while (m_Renderer.pollInput(input, timeout))
+        {
+            if (!handleInput(input))
+            {
+                return;
+            }
+            m_RedrawRequired = true;
+            timeout = 0;
+        }
+    }
+}
+
+bool GameView::handleInput(const Renderer::Input &input)
+{
+    switch (input.type)
+    {
+        case Renderer::Input::QUIT:
+            return false;
+        case Renderer::Input::PRESS_CELL:
+            m_PressedPos = input.pos;
+            m_CellPressed = true;
+            break;
+        case Renderer::Input::PRESS_EMOJI:
+            m_EmojiPressed = true;
+            break;
+        case Renderer::Input::OPEN:
+            sendCommand(GameLogic::Command::OPEN, input.pos);
+            m_CellPressed = false;
+            m_EmojiPressed = false;
+            break;
+        case Renderer::Input::RESET:
+            sendCommand(GameLogic::Command::RESET);
+            m_PressedPos = Board::POS_UNDEFINED;
+            m_CellPressed = false;
+            m_EmojiPressed = false;
+            break;
+        case Renderer::Input::RELEASE:
+            m_CellPressed = false;
+            m_EmojiPressed = false;
+            break;
+        case Renderer::Input::NEXT_STATE:
+            sendCommand(GameLogic::Command::NEXT_STATE, input.pos);
+            break;
+        case Renderer::Input::UNDO:
+            sendCommand(GameLogic::Command::UNDO);
+            break;
+        case Renderer::Input::REDO:
+            sendCommand(GameLogic::Command::REDO);
+            break;
+        case Renderer::Input::NONE:
+            break;
+    }
+    return true;
+}
+
+void GameView::sendCommand(GameLogic::Command::Type type, Board::Pos p)
+{
+    if (!m_Game.push({type, p}))
+    {
+        LOG("Game logic is busy, command dropped");
+    }
+}
+
+void GameView::draw()
+{
+    m_Snapshot = &m_Game.getSnapshot();
+    if (m_Snapshot->version != m_LastDrawVersion
+        || m_Snapshot->elapsedSec != m_LastDrawSec)
+    {
+        m_RedrawRequired = true;
+    }
+    if (!m_RedrawRequired)
+    {
+        return;
+    }
+    m_RedrawRequired = false;
+    m_LastDrawVersion = m_Snapshot->version;
+    m_LastDrawSec = m_Snapshot->elapsedSec;
+
+    // Translate the board one row at a time, then draw from the result
+    size_t nCols = m_Snapshot->dims.nCols;
+    m_CellSprites.resize(m_Snapshot->cells.size());
+    for (size_t i = 0; i < m_CellSprites.size(); i += nCols)
+    {
+        SpriteAtlas::translateRow(m_Snapshot->state, &m_Snapshot->cells[i],
+            nCols, &m_CellSprites[i]);
+    }
+    if (m_CellPressed && m_PressedPos != Board::POS_UNDEFINED)
+    {
+        pressCell(m_PressedPos);
+    }
+
+    m_Renderer.drawBoard(m_Snapshot->dims, m_CellSprites.data());
+    m_Renderer.drawBanner(m_Snapshot->nMinesRemaining, m_LastDrawSec,
+        getEmoji());
+    m_Renderer.present();
+}
+
+void GameView::pressCell(Board::Pos pos)
+{
+    // A held hidden cell looks opened, a held number shows which of its
+    // neighbours a release would open
+    Board::Cell::State state = m_Snapshot->getState(pos);
+    if (state == Board::Cell::HIDDEN)
+    {
+        m_CellSprites[pos] = SpriteAtlas::CELL_ZERO;
+    }
+    else if (state == Board::Cell::SHOWN)
+    {
+        forEachNeighbor<Board::Topology>(m_Snapshot->dims, pos,
+            [&](Board::Pos p) {
+                Board::Cell::State s = m_Snapshot->getState(p);
+                if (s != Board::Cell::SHOWN && s != Board::Cell::FLAGGED)
+                {
+                    m_CellSprites[p] = SpriteAtlas::CELL_ZERO;
+                }
+            });
+    }
+}
+
+SpriteAtlas::Sprite GameView::getEmoji() const
+{
+    if (m_EmojiPressed)
+    {
+        return SpriteAtlas::EMOJI_SELECTING;
+    }
+    if (m_Snapshot->isWon())
+    {
+        return SpriteAtlas::EMOJI_WON;
+    }
+    if (m_Snapshot->isLost())
+    {
+        return SpriteAtlas::EMOJI_LOST;
+    }
+    if (m_CellPressed)
+    {
+        return SpriteAtlas::EMOJI_CELL_SELECTING;
+    }
+    return SpriteAtlas::EMOJI_PLAYING;
+}
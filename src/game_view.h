@@ -0,0 +1,53 @@
+#ifndef CANH_GAME_VIEW_H
+#define CANH_GAME_VIEW_H
+
+#include "board.h"
+#include "game_logic.h"
+#include "renderer.h"
+#include "timer.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Plays a board on a GameLogic thread through any Renderer. Everything that
+// does not depend on the frontend lives here: translating snapshots to
+// sprites, drawing held cells pressed, choosing the emoji and turning inputs
+// into commands. A frame is drawn only when something visible changed.
+class GameView
+{
+public:
+    // Finished games are recorded to statsPath and the moves of the current
+    // one to movesPath, unless they are empty
+    GameView(Renderer &renderer, Board::Size nRows, Board::Size nCols,
+        Board::Size nMines, Board::Size nLayers = 1,
+        const std::string &statsPath = "", const std::string &movesPath = "");
+
+    // Returns when the renderer reports QUIT
+    void loop();
+
+private:
+    // Longest wait for input, which bounds how late a new snapshot is drawn
+    static const int INPUT_TIMEOUT_MS = 16;
+
+    Renderer &m_Renderer;
+    GameLogic m_Game;
+    const GameLogic::Snapshot *m_Snapshot;
+    std::vector<uint8_t> m_CellSprites;
+    uint64_t m_LastDrawVersion;
+    Timer::Sec m_LastDrawSec;
+    bool m_RedrawRequired;
+
+    Board::Pos m_PressedPos;
+    bool m_CellPressed;
+    bool m_EmojiPressed;
+
+    bool handleInput(const Renderer::Input &input);
+    void sendCommand(GameLogic::Command::Type type,
+        Board::Pos p = Board::POS_UNDEFINED);
+    void draw();
+    void pressCell(Board::Pos p);
+    SpriteAtlas::Sprite getEmoji() const;
+};
+
+#endif
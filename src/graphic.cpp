@@ -1,77 +1,51 @@
 #include "graphic.h"
 #include "board.h"
+#include "infinite_board.h"
+#include "renderer.h"
+#include "sprite_atlas.h"
 #include "util.h"
 #include "timer.h"
 
 #include <SDL2/SDL.h>
-#include <SDL2/SDL_image.h>
+#ifdef CANH_USE_SDL_IMAGE
+#   include <SDL2/SDL_image.h>
+#endif
 #include <vector>
 #include <cstddef>
 #include <string>
 #include <memory>
-
-const Graphic::Size Graphic::CELL_W     = 16;
-const Graphic::Size Graphic::CELL_H     = 16;
-const Graphic::Size Graphic::COUNT_W    = 13;
-const Graphic::Size Graphic::COUNT_H    = 23;
-const Graphic::Size Graphic::EMOJI_W    = 26;
-const Graphic::Size Graphic::EMOJI_H    = 26;
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#ifdef __linux__
+#   include <ctime>
+#   include <unistd.h>
+#endif
 
 Graphic::Size Graphic::s_NIns = 0;
 
 const std::string Graphic::SPRITE_PATH = "sprite.png";
-std::vector<SDL_Rect> Graphic::SPRITE_RECTS(Graphic::SPRITE_TOTAL);
-
-void Graphic::initSpriteRects()
-{
-    SPRITE_RECTS[CELL_ZERO]     = {0*CELL_W,  0, CELL_W, CELL_H};
-    SPRITE_RECTS[CELL_ONE]      = {1*CELL_W,  0, CELL_W, CELL_H};
-    SPRITE_RECTS[CELL_TWO]      = {2*CELL_W,  0, CELL_W, CELL_H};
-    SPRITE_RECTS[CELL_THREE]    = {3*CELL_W,  0, CELL_W, CELL_H};
-    SPRITE_RECTS[CELL_FOUR]     = {4*CELL_W,  0, CELL_W, CELL_H};
-    SPRITE_RECTS[CELL_FIVE]     = {5*CELL_W,  0, CELL_W, CELL_H};
-    SPRITE_RECTS[CELL_SIX]      = {6*CELL_W,  0, CELL_W, CELL_H};
-    SPRITE_RECTS[CELL_SEVEN]    = {7*CELL_W,  0, CELL_W, CELL_H};
-    SPRITE_RECTS[CELL_EIGHT]    = {8*CELL_W,  0, CELL_W, CELL_H};
-
-    SPRITE_RECTS[CELL_MINE]           = {0*CELL_W, CELL_H, CELL_W, CELL_H};
-    SPRITE_RECTS[CELL_MINE_WRONG]     = {1*CELL_W, CELL_H, CELL_W, CELL_H};
-    SPRITE_RECTS[CELL_MINE_CURRENT]   = {2*CELL_W, CELL_H, CELL_W, CELL_H};
-    SPRITE_RECTS[CELL_QUESTION_MARK]  = {3*CELL_W, CELL_H, CELL_W, CELL_H};
-    SPRITE_RECTS[CELL_FLAG]           = {4*CELL_W, CELL_H, CELL_W, CELL_H};
-    SPRITE_RECTS[CELL_UNOPENED]       = {5*CELL_W, CELL_H, CELL_W, CELL_H};
-
-    SPRITE_RECTS[COUNT_ZERO]    = {0*COUNT_W, 2*CELL_H, COUNT_W, COUNT_H};
-    SPRITE_RECTS[COUNT_ONE]     = {1*COUNT_W, 2*CELL_H, COUNT_W, COUNT_H};
-    SPRITE_RECTS[COUNT_TWO]     = {2*COUNT_W, 2*CELL_H, COUNT_W, COUNT_H};
-    SPRITE_RECTS[COUNT_THREE]   = {3*COUNT_W, 2*CELL_H, COUNT_W, COUNT_H};
-    SPRITE_RECTS[COUNT_FOUR]    = {4*COUNT_W, 2*CELL_H, COUNT_W, COUNT_H};
-    SPRITE_RECTS[COUNT_FIVE]    = {5*COUNT_W, 2*CELL_H, COUNT_W, COUNT_H};
-    SPRITE_RECTS[COUNT_SIX]     = {6*COUNT_W, 2*CELL_H, COUNT_W, COUNT_H};
-    SPRITE_RECTS[COUNT_SEVEN]   = {7*COUNT_W, 2*CELL_H, COUNT_W, COUNT_H};
-    SPRITE_RECTS[COUNT_EIGHT]   = {8*COUNT_W, 2*CELL_H, COUNT_W, COUNT_H};
-    SPRITE_RECTS[COUNT_NINE]    = {9*COUNT_W, 2*CELL_H, COUNT_W, COUNT_H};
-
-    Pos emojiH = 2 * CELL_H + COUNT_H;
-    SPRITE_RECTS[EMOJI_SELECTING]     = {0*EMOJI_W, emojiH, EMOJI_W, EMOJI_H};
-    SPRITE_RECTS[EMOJI_PLAYING]       = {1*EMOJI_W, emojiH, EMOJI_W, EMOJI_H};
-    SPRITE_RECTS[EMOJI_CELL_SELECTING]= {2*EMOJI_W, emojiH, EMOJI_W, EMOJI_H};
-    SPRITE_RECTS[EMOJI_LOST]          = {3*EMOJI_W, emojiH, EMOJI_W, EMOJI_H};
-    SPRITE_RECTS[EMOJI_WON]           = {4*EMOJI_W, emojiH, EMOJI_W, EMOJI_H};
-}
-
 
-SDL_Texture* createTexture(SDL_Renderer *, const std::string &);
+SDL_Texture* createTexture(SDL_Renderer *);
+#ifdef CANH_USE_SDL_IMAGE
+SDL_Texture* loadTexture(SDL_Renderer *, const std::string &);
+#endif
 bool insideRect(Graphic::Size x, Graphic::Size y, const SDL_Rect &rect);
+SDL_Rect getSpriteRect(uint8_t sprite);
+long getMsSinceExec();
 
 Graphic::Graphic(const std::string &title, Size w, Size h)
     : m_Window(nullptr),
     m_Renderer(nullptr),
     m_SpriteTexture(nullptr),
     m_RedrawRequired(true),
+    m_Presented(false),
     m_ScaleW(1.0),
     m_ScaleH(1.0),
-    m_Board(nullptr)
+    m_InfiniteBoard(nullptr),
+    m_InfiniteDensity(0.0),
+    m_LastDrawSec(0)
 {
     if (s_NIns == 0)
     {
@@ -80,12 +54,13 @@ Graphic::Graphic(const std::string &title, Size w, Size h)
             throw Exception("Can not initialize SDL!");
         }
 
+#ifdef CANH_USE_SDL_IMAGE
         IMG_InitFlags imgFlag = IMG_INIT_PNG;
         if ((IMG_Init(imgFlag) & imgFlag) != imgFlag)
         {
             throw Exception("Can not initialize SDL_image!");
         }
-        initSpriteRects();
+#endif
     }
 
     m_Window = SDL_CreateWindow(title.c_str(), SDL_WINDOWPOS_UNDEFINED,
@@ -102,10 +77,16 @@ Graphic::Graphic(const std::string &title, Size w, Size h)
         throw Exception("Can not create renderer!");
     }
 
-    m_SpriteTexture = createTexture(m_Renderer, SPRITE_PATH);
+#ifdef CANH_USE_SDL_IMAGE
+    // A sprite.png in the working directory replaces the embedded one
+    m_SpriteTexture = loadTexture(m_Renderer, SPRITE_PATH);
+#endif
+    if (m_SpriteTexture == nullptr)
+    {
+        m_SpriteTexture = createTexture(m_Renderer);
+    }
     if (m_SpriteTexture == nullptr) {
-        throw Exception("Can not create texture from \""
-                        + SPRITE_PATH + "\"!");
+        throw Exception("Can not create sprite texture!");
     }
 
     s_NIns ++;
@@ -122,34 +103,76 @@ Graphic::~Graphic()
 
     if (s_NIns == 0)
     {
-
+#ifdef CANH_USE_SDL_IMAGE
         IMG_Quit();
+#endif
         SDL_Quit();
     }
 }
 
-SDL_Texture* createTexture(SDL_Renderer *renderer, const std::string &path)
+SDL_Texture* createTexture(SDL_Renderer *renderer)
+{
+    SDL_Texture *texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32,
+        SDL_TEXTUREACCESS_STATIC, SpriteAtlas::IMAGE_W, SpriteAtlas::IMAGE_H);
+    if (texture == nullptr)
+    {
+        return nullptr;
+    }
+    if (SDL_UpdateTexture(texture, nullptr, SpriteAtlas::PIXELS,
+        SpriteAtlas::IMAGE_W * 4) != 0)
+    {
+        SDL_DestroyTexture(texture);
+        return nullptr;
+    }
+    return texture;
+}
+
+#ifdef CANH_USE_SDL_IMAGE
+SDL_Texture* loadTexture(SDL_Renderer *renderer, const std::string &path)
 {
     SDL_Surface *surface = IMG_Load(path.c_str());
     if (surface == nullptr) {
-        throw Graphic::Exception("Cannot read image \"" + path + "\"!");
+        return nullptr;
     }
 
     SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
     SDL_FreeSurface(surface);
     return texture;
 }
+#endif
 
-void Graphic::createBoard(Board::Size nRows, Board::Size nCols,
-    Board::Size nMines, const SDL_Rect &boardRect)
+void Graphic::createBoardView(const Dims &dims, const SDL_Rect &boardRect)
 {
-    m_Board = std::make_unique<Board>(nRows, nCols, nMines);
+    m_InfiniteBoard.reset();
+    m_Dims = dims;
     m_BoardRect = boardRect;
     m_BoardSelecting = false;
     m_BoardLastPos = Board::POS_UNDEFINED;
 
-    m_ScaleW = boardRect.w / m_Board->getNCols() / CELL_W;
-    m_ScaleH = boardRect.h / m_Board->getNRows() / CELL_H;
+    m_ScaleW = boardRect.w
+        / Board::Topology::getLayoutCols(m_Dims) / Atlas::CELL_W;
+    m_ScaleH = boardRect.h
+        / Board::Topology::getLayoutRows(m_Dims) / Atlas::CELL_H;
+}
+
+void Graphic::createInfiniteBoard(Board::Size nViewRows, Board::Size nViewCols,
+    double density, const SDL_Rect &boardRect)
+{
+    m_InfiniteBoard = std::make_unique<InfiniteBoard>(density,
+        Util::getRNG()());
+    m_InfiniteDensity = density;
+    m_BoardRect = boardRect;
+    m_BoardSelecting = false;
+
+    m_ViewNRows = nViewRows;
+    m_ViewNCols = nViewCols;
+    m_ViewRow = -static_cast<InfiniteBoard::Coord>(nViewRows / 2);
+    m_ViewCol = -static_cast<InfiniteBoard::Coord>(nViewCols / 2);
+    m_LastRow = m_ViewRow;
+    m_LastCol = m_ViewCol;
+
+    m_ScaleW = boardRect.w / nViewCols / Atlas::CELL_W;
+    m_ScaleH = boardRect.h / nViewRows / Atlas::CELL_H;
 }
 
 void Graphic::createBanner(const SDL_Rect &bannerRect)
@@ -161,10 +184,10 @@ void Graphic::createBanner(const SDL_Rect &bannerRect)
     Pos cY = m_BannerRect.y + m_BannerRect.h / 2;
 
     m_EmojiRect = {
-        cX - static_cast<Pos>(EMOJI_W * m_ScaleW / 2),
-        cY - static_cast<Pos>(EMOJI_H * m_ScaleH / 2),
-        static_cast<Pos>(EMOJI_W * m_ScaleW),
-        static_cast<Pos>(EMOJI_H * m_ScaleH)
+        cX - static_cast<Pos>(Atlas::EMOJI_W * m_ScaleW / 2),
+        cY - static_cast<Pos>(Atlas::EMOJI_H * m_ScaleH / 2),
+        static_cast<Pos>(Atlas::EMOJI_W * m_ScaleW),
+        static_cast<Pos>(Atlas::EMOJI_H * m_ScaleH)
     };
 }
 
@@ -178,7 +201,7 @@ void Graphic::loop()
         draw();
         while (SDL_PollEvent(&e) != 0)
         {
-            if(!handleEvent(e))
+            if(!handleInfiniteEvent(e))
             {
                 quit = true;
                 break;
@@ -189,7 +212,7 @@ void Graphic::loop()
 
 void Graphic::draw()
 {
-    Timer::Sec sec = m_Board->getElapsedSec();
+    Timer::Sec sec = m_InfiniteBoard->getElapsedSec();
     if (sec != m_LastDrawSec)
     {
         m_RedrawRequired = true;
@@ -199,210 +222,214 @@ void Graphic::draw()
         return;
     }
     m_RedrawRequired = false;
-    m_LastDrawSec = sec;
 
     SDL_RenderClear(m_Renderer);
-    if (m_Board != nullptr)
+    drawInfiniteBoard();
+    if (m_BoardSelecting && m_InfiniteBoard->getState(m_LastRow,
+        m_LastCol) == Board::Cell::HIDDEN)
     {
-        drawBoard();
-        if (m_BoardSelecting)
-        {
-            if (m_Board->getState(m_BoardLastPos) == Board::Cell::HIDDEN)
-            {
-                drawCell(m_BoardLastPos, SPRITE_RECTS[CELL_ZERO]);
-            }
-            else if (m_Board->getState(m_BoardLastPos) == Board::Cell::SHOWN)
-            {
-                drawCellNeighborsOpening(m_BoardLastPos);
-            }
-        }
+        drawInfiniteCell(m_LastRow, m_LastCol,
+            getSpriteRect(Atlas::CELL_ZERO));
     }
-    drawEmoji();
-    drawRemainingNMines();
-    drawElapsedSec();
-    SDL_RenderPresent(m_Renderer);
+
+    Atlas::Sprite emoji = Atlas::EMOJI_PLAYING;
+    if (m_EmojiSelecting)
+    {
+        emoji = Atlas::EMOJI_SELECTING;
+    }
+    else if (m_InfiniteBoard->isLost())
+    {
+        emoji = Atlas::EMOJI_LOST;
+    }
+    else if (m_BoardSelecting)
+    {
+        emoji = Atlas::EMOJI_CELL_SELECTING;
+    }
+
+    // There is no mine total to count down from, show the flags instead
+    drawBanner(std::min<size_t>(999, m_InfiniteBoard->getNFlagged()), sec,
+        emoji);
+    present();
 }
 
-void Graphic::drawBoard() const
+void Graphic::drawBoard(const Dims &dims, const uint8_t *sprites)
 {
-    for (Board::Pos p = 0; p < m_Board->getNCells(); p ++)
+    m_Dims = dims;
+    SDL_RenderClear(m_Renderer);
+
+    Board::Pos nCells = static_cast<Board::Pos>(
+        dims.nLayers * dims.nRows * dims.nCols);
+    for (Board::Pos p = 0; p < nCells; p ++)
     {
-        drawCell(p, getSpriteRect(p));
+        drawCell(p, getSpriteRect(sprites[p]));
     }
 }
 
-void Graphic::drawCell(Board::Pos p, const SDL_Rect &spriteRect) const
+void Graphic::drawBanner(Board::Size nMinesRemaining, Timer::Sec sec,
+    SpriteAtlas::Sprite emoji)
 {
-    Board::Pos r = m_Board->getRow(p);
-    Board::Pos c = m_Board->getCol(p);
-
-    SDL_Rect destRect = {
-        m_BoardRect.x + c * static_cast<Pos>(CELL_W * m_ScaleW),
-        m_BoardRect.y + r * static_cast<Pos>(CELL_H * m_ScaleH),
-        static_cast<Pos>(CELL_W * m_ScaleW),
-        static_cast<Pos>(CELL_H * m_ScaleH)
-    };
+    m_LastDrawSec = sec;
 
-    SDL_RenderCopy(m_Renderer, m_SpriteTexture, &spriteRect, &destRect);
+    SDL_Rect spriteRect = getSpriteRect(emoji);
+    SDL_RenderCopy(m_Renderer, m_SpriteTexture, &spriteRect, &m_EmojiRect);
+    drawCount(nMinesRemaining, false);
+    drawCount(sec, true);
 }
 
-void Graphic::drawCellNeighborsOpening(Board::Pos pos) const
+void Graphic::present()
 {
-    for (Board::Pos p : m_Board->getNeighbors(pos))
+    SDL_RenderPresent(m_Renderer);
+
+    if (!m_Presented)
     {
-        Board::Cell::State state = m_Board->getState(p);
-        if (state == Board::Cell::SHOWN || state == Board::Cell::FLAGGED)
+        m_Presented = true;
+        long ms = getMsSinceExec();
+        if (ms >= 0)
         {
-            continue;
+            LOG("Startup time: " << ms << " ms from process start");
+        }
+        else
+        {
+            LOG("Startup time: " << std::chrono::duration_cast<
+                std::chrono::milliseconds>(std::chrono::steady_clock::now()
+                - Util::getStartTime()).count() << " ms from main");
         }
-        drawCell(p, SPRITE_RECTS[CELL_ZERO]);
     }
 }
 
-void Graphic::drawEmoji() const
+bool Graphic::pollInput(Input &input, int timeoutMs)
 {
-    Sprite sprite = EMOJI_PLAYING;
-    if (m_EmojiSelecting)
-    {
-        sprite = EMOJI_SELECTING;
-    }
-    else if (m_Board->isWon())
-    {
-        sprite = EMOJI_WON;
-    }
-    else if (m_Board->isLost())
-    {
-        sprite = EMOJI_LOST;
-    }
-    else if (m_BoardSelecting)
+    SDL_Event e;
+    int ready = timeoutMs > 0 ? SDL_WaitEventTimeout(&e, timeoutMs)
+                              : SDL_PollEvent(&e);
+    if (ready == 0)
     {
-        sprite = EMOJI_CELL_SELECTING;
+        return false;
     }
-
-    SDL_RenderCopy(m_Renderer, m_SpriteTexture,
-        &SPRITE_RECTS[sprite], &m_EmojiRect);
+    input = mapEvent(e);
+    return true;
 }
 
-void Graphic::drawElapsedSec() const
+void Graphic::drawCell(Board::Pos p, const SDL_Rect &spriteRect) const
 {
-    Timer::Sec sec = m_LastDrawSec > 999 ? 999 : m_LastDrawSec;
+    Pos w = static_cast<Pos>(Atlas::CELL_W * m_ScaleW);
+    Pos h = static_cast<Pos>(Atlas::CELL_H * m_ScaleH);
+    Pos layerSize = m_Dims.nRows * m_Dims.nCols;
+    int x = 0, y = 0;
+    Board::Topology::getCellOrigin(m_Dims, p / layerSize,
+        p % layerSize / m_Dims.nCols, p % m_Dims.nCols, w, h, x, y);
 
-    Timer::Sec digits[] = {
-        static_cast<Timer::Sec>(sec / 100),
-        static_cast<Timer::Sec>((sec % 100) / 10),
-        static_cast<Timer::Sec>(sec % 10)
-    };
+    SDL_Rect destRect = {m_BoardRect.x + x, m_BoardRect.y + y, w, h};
 
-    Pos cY = m_BannerRect.y + m_BannerRect.h / 2;
+    SDL_RenderCopy(m_Renderer, m_SpriteTexture, &spriteRect, &destRect);
+}
 
-    for (unsigned i = 0; i < 3; i ++)
+void Graphic::drawInfiniteBoard() const
+{
+    for (Board::Size i = 0; i < m_ViewNRows; i ++)
     {
-        SDL_Rect destRect = {
-            m_BannerRect.x + m_BannerRect.w
-                - static_cast<Pos>((3.5 - i) * COUNT_W * m_ScaleW),
-            cY - static_cast<Pos>(COUNT_H * m_ScaleH / 2),
-            static_cast<Pos>(COUNT_W * m_ScaleW),
-            static_cast<Pos>(COUNT_H * m_ScaleH)
-        };
-        SDL_RenderCopy(m_Renderer, m_SpriteTexture,
-            &SPRITE_RECTS[COUNT_ZERO + digits[i]], &destRect);
+        for (Board::Size j = 0; j < m_ViewNCols; j ++)
+        {
+            InfiniteBoard::Coord r = m_ViewRow + i;
+            InfiniteBoard::Coord c = m_ViewCol + j;
+            drawInfiniteCell(r, c, getInfiniteSpriteRect(r, c));
+        }
     }
 }
 
-void Graphic::drawRemainingNMines() const
+void Graphic::drawInfiniteCell(InfiniteBoard::Coord r, InfiniteBoard::Coord c,
+    const SDL_Rect &spriteRect) const
 {
-    Board::Size nMines = m_Board->getNMinesRemaining();
-    Board::Size digits[] = {
-        static_cast<Board::Size>(nMines / 100),
-        static_cast<Board::Size>((nMines % 100) / 10),
-        static_cast<Board::Size>(nMines % 10)
+    Pos w = static_cast<Pos>(Atlas::CELL_W * m_ScaleW);
+    Pos h = static_cast<Pos>(Atlas::CELL_H * m_ScaleH);
+    SDL_Rect destRect = {
+        m_BoardRect.x + (c - m_ViewCol) * w,
+        m_BoardRect.y + (r - m_ViewRow) * h,
+        w,
+        h
+    };
+
+    SDL_RenderCopy(m_Renderer, m_SpriteTexture, &spriteRect, &destRect);
+}
+
+void Graphic::drawCount(unsigned count, bool alignRight) const
+{
+    count = count > 999 ? 999 : count;
+
+    unsigned digits[] = {
+        count / 100,
+        (count % 100) / 10,
+        count % 10
     };
 
     Pos cY = m_BannerRect.y + m_BannerRect.h / 2;
 
     for (unsigned i = 0; i < 3; i ++)
     {
+        Pos x = alignRight
+            ? m_BannerRect.x + m_BannerRect.w
+                - static_cast<Pos>((3.5 - i) * Atlas::COUNT_W * m_ScaleW)
+            : m_BannerRect.x
+                + static_cast<Pos>((i + 0.5) * Atlas::COUNT_W * m_ScaleW);
         SDL_Rect destRect = {
-            m_BannerRect.x + static_cast<Pos>((i + 0.5) * COUNT_W * m_ScaleW),
-            cY - static_cast<Pos>(COUNT_H * m_ScaleH / 2),
-            static_cast<Pos>(COUNT_W * m_ScaleW),
-            static_cast<Pos>(COUNT_H * m_ScaleH)
+            x,
+            cY - static_cast<Pos>(Atlas::COUNT_H * m_ScaleH / 2),
+            static_cast<Pos>(Atlas::COUNT_W * m_ScaleW),
+            static_cast<Pos>(Atlas::COUNT_H * m_ScaleH)
         };
-        SDL_RenderCopy(m_Renderer, m_SpriteTexture,
-            &SPRITE_RECTS[COUNT_ZERO + digits[i]], &destRect);
+        SDL_Rect spriteRect = getSpriteRect(Atlas::COUNT_ZERO + digits[i]);
+        SDL_RenderCopy(m_Renderer, m_SpriteTexture, &spriteRect, &destRect);
     }
 }
 
 Board::Pos Graphic::getBoardPos(Graphic::Pos x, Graphic::Pos y) const
 {
-    Board::Pos r = (y - m_BoardRect.y) / (CELL_W * m_ScaleW);
-    Board::Pos c = (x - m_BoardRect.x) / (CELL_H * m_ScaleH);
+    int l = 0, r = 0, c = 0;
+    if (!Board::Topology::getCellAt(m_Dims, x - m_BoardRect.x,
+        y - m_BoardRect.y, static_cast<Pos>(Atlas::CELL_W * m_ScaleW),
+        static_cast<Pos>(Atlas::CELL_H * m_ScaleH), l, r, c))
+    {
+        return Board::POS_UNDEFINED;
+    }
 
-    return m_Board->convertPos(r, c);
+    return static_cast<Board::Pos>((l * m_Dims.nRows + r) * m_Dims.nCols + c);
 }
 
-SDL_Rect Graphic::getSpriteRect(Board::Pos p) const
+SDL_Rect Graphic::getInfiniteSpriteRect(InfiniteBoard::Coord r,
+    InfiniteBoard::Coord c) const
 {
-    Board::Cell::State cellState = m_Board->getState(p);
-    Board::Cell::Value cellValue = m_Board->getValue(p);
+    Board::Cell::State cellState = m_InfiniteBoard->getState(r, c);
 
-    if (m_Board->isWon())
+    if (m_InfiniteBoard->isLost() && cellState != Board::Cell::SHOWN)
     {
-        if (cellValue == Board::Cell::MINE)
-        {
-            return SPRITE_RECTS[CELL_FLAG];
-        }
-        else
+        bool mine = m_InfiniteBoard->isMine(r, c);
+        if (cellState == Board::Cell::FLAGGED)
         {
-            ASSERT(0 <= cellValue && cellValue <= 8);
-            return SPRITE_RECTS[CELL_ZERO + cellValue];
+            return getSpriteRect(mine ? Atlas::CELL_FLAG
+                                      : Atlas::CELL_MINE_WRONG);
         }
+        return getSpriteRect(mine ? Atlas::CELL_MINE : Atlas::CELL_UNOPENED);
     }
-    else if (m_Board->isLost())
+
+    switch (cellState)
     {
-        if (cellValue == Board::Cell::MINE)
-        {
-            if (p == m_BoardLastPos)
-            {
-                return SPRITE_RECTS[CELL_MINE_CURRENT];
-            }
-            else
-            {
-                return SPRITE_RECTS[CELL_MINE];
-            }
-        }
-        else
-        {
-            if (cellState == Board::Cell::HIDDEN)
-            {
-                return SPRITE_RECTS[CELL_UNOPENED];
-            }
-            else if (cellState == Board::Cell::FLAGGED)
-            {
-                return SPRITE_RECTS[CELL_MINE_WRONG];
-            }
-            else
-            {
-                ASSERT(0 <= cellValue && cellValue <= 8);
-                return SPRITE_RECTS[CELL_ZERO + cellValue];
-            }
-        }
+        case Board::Cell::HIDDEN:
+            return getSpriteRect(Atlas::CELL_UNOPENED);
+        case Board::Cell::FLAGGED:
+            return getSpriteRect(Atlas::CELL_FLAG);
+        case Board::Cell::UNKNOWN:
+            return getSpriteRect(Atlas::CELL_QUESTION_MARK);
+        default:
+            break;
     }
-    else
+
+    Board::Cell::Value cellValue = m_InfiniteBoard->getValue(r, c);
+    if (cellValue == Board::Cell::MINE)
     {
-        switch (cellState)
-        {
-            case Board::Cell::HIDDEN:
-                return SPRITE_RECTS[CELL_UNOPENED];
-            case Board::Cell::FLAGGED:
-                return SPRITE_RECTS[CELL_FLAG];
-            case Board::Cell::UNKNOWN:
-                return SPRITE_RECTS[CELL_QUESTION_MARK];
-            case Board::Cell::SHOWN:
-                ASSERT(0 <= cellValue && cellValue <= 8);
-                return SPRITE_RECTS[CELL_ZERO + cellValue];
-        }
+        return getSpriteRect(Atlas::CELL_MINE_CURRENT);
     }
+    ASSERT(0 <= cellValue && cellValue <= 8);
+    return getSpriteRect(Atlas::CELL_ZERO + cellValue);
 }
 
 void Graphic::showError(const std::string &m)
@@ -411,18 +438,119 @@ void Graphic::showError(const std::string &m)
                              "Error", m.c_str(), nullptr);
 }
 
+SDL_Rect getSpriteRect(uint8_t sprite)
+{
+    const SpriteAtlas::Rect &rect = SpriteAtlas::RECTS[sprite];
+    return {rect.x, rect.y, rect.w, rect.h};
+}
+
 bool insideRect(Graphic::Pos x, Graphic::Pos y, const SDL_Rect &rect)
 {
     return rect.x <= x && x < rect.x + rect.w
            && rect.y <= y && y < rect.y + rect.h;
 }
 
-bool Graphic::handleEvent(const SDL_Event &e)
+Renderer::Input Graphic::mapEvent(const SDL_Event &e)
 {
+    Input input = {Input::NONE, Board::POS_UNDEFINED};
+    switch(e.type)
+    {
+        case SDL_QUIT:
+            input.type = Input::QUIT;
+            break;
+        case SDL_KEYDOWN:
+            if (e.key.keysym.mod & (KMOD_CTRL | KMOD_GUI))
+            {
+                if (e.key.keysym.sym == SDLK_z
+                    && !(e.key.keysym.mod & KMOD_SHIFT))
+                {
+                    input.type = Input::UNDO;
+                }
+                else if (e.key.keysym.sym == SDLK_z
+                    || e.key.keysym.sym == SDLK_y)
+                {
+                    input.type = Input::REDO;
+                }
+            }
+            break;
+        case SDL_MOUSEBUTTONDOWN:
+            if (insideRect(e.button.x, e.button.y, m_EmojiRect))
+            {
+                input.type = Input::PRESS_EMOJI;
+            }
+            else if (insideRect(e.button.x, e.button.y, m_BoardRect))
+            {
+                m_BoardLastPos = getBoardPos(e.button.x, e.button.y);
+                input.pos = m_BoardLastPos;
+                if (e.button.button == SDL_BUTTON_LEFT)
+                {
+                    input.type = Input::PRESS_CELL;
+                }
+                else if (e.button.button == SDL_BUTTON_RIGHT)
+                {
+                    input.type = Input::NEXT_STATE;
+                }
+            }
+            break;
+        case SDL_MOUSEBUTTONUP:
+            if (e.button.button == SDL_BUTTON_LEFT)
+            {
+                input.type = Input::RELEASE;
+                if (insideRect(e.button.x, e.button.y, m_EmojiRect))
+                {
+                    input.type = Input::RESET;
+                    m_BoardLastPos = Board::POS_UNDEFINED;
+                }
+                else if (insideRect(e.button.x, e.button.y, m_BoardRect)
+                    && m_BoardLastPos == getBoardPos(e.button.x, e.button.y))
+                {
+                    input.type = Input::OPEN;
+                    input.pos = m_BoardLastPos;
+                }
+            }
+            break;
+        default:
+            break;
+    }
+    return input;
+}
+
+bool Graphic::handleInfiniteEvent(const SDL_Event &e)
+{
+    InfiniteBoard::Coord r = 0;
+    InfiniteBoard::Coord c = 0;
+    if (e.type == SDL_MOUSEBUTTONDOWN || e.type == SDL_MOUSEBUTTONUP)
+    {
+        r = m_ViewRow + (e.button.y - m_BoardRect.y)
+            / static_cast<Pos>(Atlas::CELL_H * m_ScaleH);
+        c = m_ViewCol + (e.button.x - m_BoardRect.x)
+            / static_cast<Pos>(Atlas::CELL_W * m_ScaleW);
+    }
+
     switch(e.type)
     {
         case SDL_QUIT:
             return false;
+        case SDL_KEYDOWN:
+            switch (e.key.keysym.sym)
+            {
+                case SDLK_UP:
+                    m_ViewRow --;
+                    break;
+                case SDLK_DOWN:
+                    m_ViewRow ++;
+                    break;
+                case SDLK_LEFT:
+                    m_ViewCol --;
+                    break;
+                case SDLK_RIGHT:
+                    m_ViewCol ++;
+                    break;
+                default:
+                    break;
+            }
+            m_RedrawRequired = true;
+            break;
         case SDL_MOUSEBUTTONDOWN:
             if (insideRect(e.button.x, e.button.y, m_EmojiRect))
             {
@@ -431,7 +559,8 @@ bool Graphic::handleEvent(const SDL_Event &e)
             }
             else if (insideRect(e.button.x, e.button.y, m_BoardRect))
             {
-                m_BoardLastPos = getBoardPos(e.button.x, e.button.y);
+                m_LastRow = r;
+                m_LastCol = c;
                 if (e.button.button == SDL_BUTTON_LEFT)
                 {
                     m_BoardSelecting = true;
@@ -439,7 +568,7 @@ bool Graphic::handleEvent(const SDL_Event &e)
                 }
                 else if (e.button.button == SDL_BUTTON_RIGHT)
                 {
-                    m_Board->nextState(m_BoardLastPos);
+                    m_InfiniteBoard->nextState(r, c);
                     m_RedrawRequired = true;
                 }
             }
@@ -449,13 +578,13 @@ bool Graphic::handleEvent(const SDL_Event &e)
             {
                 if (insideRect(e.button.x, e.button.y, m_EmojiRect))
                 {
-                    createBoard(m_Board->getNRows(), m_Board->getNCols(),
-                        m_Board->getNMines(), m_BoardRect);
+                    createInfiniteBoard(m_ViewNRows, m_ViewNCols,
+                        m_InfiniteDensity, m_BoardRect);
                 }
                 else if (insideRect(e.button.x, e.button.y, m_BoardRect)
-                    && m_BoardLastPos == getBoardPos(e.button.x, e.button.y))
+                    && m_LastRow == r && m_LastCol == c)
                 {
-                    m_Board->open(m_BoardLastPos);
+                    m_InfiniteBoard->open(r, c);
                 }
                 m_EmojiSelecting = false;
                 m_BoardSelecting = false;
@@ -467,3 +596,40 @@ bool Graphic::handleEvent(const SDL_Event &e)
     }
     return true;
 }
+
+// Milliseconds since the process was created, so that loading and static
+// initialisation count too. Linux keeps the creation time in /proc/self/stat
+// in clock ticks since boot, usually 10 ms each. Returns -1 elsewhere.
+long getMsSinceExec()
+{
+#ifdef __linux__
+    std::ifstream in("/proc/self/stat");
+    std::string stat;
+    std::getline(in, stat);
+
+    // The command name may hold spaces, so fields are counted after it:
+    // the state is field 3 and the start time field 22
+    size_t nameEnd = stat.rfind(')');
+    if (nameEnd == std::string::npos)
+    {
+        return -1;
+    }
+    std::istringstream fields(stat.substr(nameEnd + 1));
+    std::string field;
+    for (int i = 3; i < 22; i ++)
+    {
+        fields >> field;
+    }
+    unsigned long long ticks;
+    timespec now;
+    if (!(fields >> ticks) || clock_gettime(CLOCK_BOOTTIME, &now) != 0)
+    {
+        return -1;
+    }
+    long hz = sysconf(_SC_CLK_TCK);
+    return static_cast<long>(now.tv_sec * 1000 + now.tv_nsec / 1000000
+        - static_cast<long long>(ticks * 1000 / hz));
+#else
+    return -1;
+#endif
+}
@@ -2,61 +2,28 @@
 #define CANH_GRAPHIC_H
 
 #include "board.h"
+#include "infinite_board.h"
+#include "renderer.h"
+#include "sprite_atlas.h"
 #include "util.h"
 #include "timer.h"
 
 #include <SDL2/SDL.h>
-#include <SDL2/SDL_image.h>
 #include <vector>
 #include <exception>
 #include <string>
 #include <memory>
 
-class Graphic
+// The SDL frontend: a window drawn with the sprite texture and played with
+// the mouse. It renders finite boards for a GameView, and plays infinite
+// boards on its own with loop().
+class Graphic : public Renderer
 {
 public:
     typedef uint32_t Size;
     typedef int32_t Pos;
     typedef SDL_Rect Rect;
 
-    enum Sprite
-    {
-        CELL_ZERO = 0,
-        CELL_ONE,
-        CELL_TWO,
-        CELL_THREE,
-        CELL_FOUR,
-        CELL_FIVE,
-        CELL_SIX,
-        CELL_SEVEN,
-        CELL_EIGHT,
-        CELL_MINE,
-        CELL_MINE_WRONG,
-        CELL_MINE_CURRENT,
-        CELL_QUESTION_MARK,
-        CELL_FLAG,
-        CELL_UNOPENED,
-
-        COUNT_ZERO,
-        COUNT_ONE,
-        COUNT_TWO,
-        COUNT_THREE,
-        COUNT_FOUR,
-        COUNT_FIVE,
-        COUNT_SIX,
-        COUNT_SEVEN,
-        COUNT_EIGHT,
-        COUNT_NINE,
-
-        EMOJI_SELECTING,
-        EMOJI_PLAYING,
-        EMOJI_CELL_SELECTING,
-        EMOJI_LOST,
-        EMOJI_WON,
-
-        SPRITE_TOTAL
-    };
-
     class Exception : public std::runtime_error
     {
     public:
@@ -68,59 +35,74 @@ public:
     Graphic(const std::string &title, Size w, Size h);
     ~Graphic();
 
-    void createBoard(Board::Size nRows, Board::Size nCols, Board::Size nMines,
-        const Rect &boardRect);
+    // Lays out a finite board of the given dimensions in boardRect
+    void createBoardView(const Dims &dims, const Rect &boardRect);
+
+    void createInfiniteBoard(Board::Size nViewRows, Board::Size nViewCols,
+        double density, const Rect &boardRect);
 
     void createBanner(const Rect &bannerRect);
 
+    // Plays the infinite board until the window is closed
     void loop();
 
+    void drawBoard(const Dims &dims, const uint8_t *sprites) override;
+    void drawBanner(Board::Size nMinesRemaining, Timer::Sec sec,
+        SpriteAtlas::Sprite emoji) override;
+    void present() override;
+    bool pollInput(Input &input, int timeoutMs) override;
+
 private:
-    static const std::string SPRITE_PATH;
+    typedef SpriteAtlas Atlas;
 
-    static const Size CELL_W;
-    static const Size CELL_H;
-    static const Size COUNT_W;
-    static const Size COUNT_H;
-    static const Size EMOJI_W;
-    static const Size EMOJI_H;
+    static const std::string SPRITE_PATH;
 
-    static std::vector<SDL_Rect> SPRITE_RECTS;
     static Size s_NIns;
 
-    static void initSpriteRects();
-
     SDL_Window *m_Window;
     SDL_Renderer *m_Renderer;
     SDL_Texture *m_SpriteTexture;
     bool m_RedrawRequired;
+    bool m_Presented;
     double m_ScaleW;
     double m_ScaleH;
 
-    std::unique_ptr<Board> m_Board;
+    Dims m_Dims;
     SDL_Rect m_BoardRect;
     bool m_BoardSelecting;
     Board::Pos m_BoardLastPos;
 
+    std::unique_ptr<InfiniteBoard> m_InfiniteBoard;
+    double m_InfiniteDensity;
+    Board::Size m_ViewNRows;
+    Board::Size m_ViewNCols;
+    InfiniteBoard::Coord m_ViewRow;
+    InfiniteBoard::Coord m_ViewCol;
+    InfiniteBoard::Coord m_LastRow;
+    InfiniteBoard::Coord m_LastCol;
+
     SDL_Rect m_BannerRect;
     SDL_Rect m_EmojiRect;
     bool m_EmojiSelecting;
 
     Timer::Sec m_LastDrawSec;
 
-    bool handleEvent(const SDL_Event &);
+    Input mapEvent(const SDL_Event &);
     void draw();
 
-    void drawBoard() const;
     void drawCell(Board::Pos p, const Rect &spriteRect) const;
-    void drawCellNeighborsOpening(Board::Pos) const;
 
-    void drawRemainingNMines() const;
-    void drawEmoji() const;
-    void drawElapsedSec() const;
+    void drawInfiniteBoard() const;
+    void drawInfiniteCell(InfiniteBoard::Coord r, InfiniteBoard::Coord c,
+        const Rect &spriteRect) const;
+    bool handleInfiniteEvent(const SDL_Event &);
+
+    void drawCount(unsigned count, bool alignRight) const;
 
-    Rect getSpriteRect(Board::Pos p) const;
     Board::Pos getBoardPos(Pos x, Pos y) const;
+
+    Rect getInfiniteSpriteRect(InfiniteBoard::Coord r,
+        InfiniteBoard::Coord c) const;
 };
 
 #endif
@@ -0,0 +1,242 @@
+#include "infinite_board.h"
+#include "util.h"
+
+#include <vector>
+#include <cstdlib>
+#include <utility>
+
+namespace
+{
+    InfiniteBoard::Coord floorDiv(InfiniteBoard::Coord a, InfiniteBoard::Coord b)
+    {
+        return a >= 0 ? a / b : -((-a - 1) / b) - 1;
+    }
+}
+
+constexpr double InfiniteBoard::MIN_DENSITY;
+
+InfiniteBoard::InfiniteBoard(double density, InfiniteBoard::Seed seed)
+    : m_State(INIT),
+    m_Threshold(0),
+    m_Seed(seed),
+    m_SafeRow(0),
+    m_SafeCol(0),
+    m_NOpened(0),
+    m_NFlagged(0),
+    m_Timer(),
+    m_Chunks()
+{
+    ASSERT(MIN_DENSITY <= density && density < 1.0);
+    m_Threshold = static_cast<uint32_t>(density * 4294967296.0);
+}
+
+InfiniteBoard::ChunkKey InfiniteBoard::getChunkKey(Coord r, Coord c)
+{
+    uint32_t cr = static_cast<uint32_t>(floorDiv(r, CHUNK_SIZE));
+    uint32_t cc = static_cast<uint32_t>(floorDiv(c, CHUNK_SIZE));
+    return (static_cast<ChunkKey>(cr) << 32) | cc;
+}
+
+size_t InfiniteBoard::getChunkIndex(Coord r, Coord c)
+{
+    Coord y = r - floorDiv(r, CHUNK_SIZE) * CHUNK_SIZE;
+    Coord x = c - floorDiv(c, CHUNK_SIZE) * CHUNK_SIZE;
+    return y * CHUNK_SIZE + x;
+}
+
+bool InfiniteBoard::isMine(Coord r, Coord c) const
+{
+    if (m_State == INIT
+        || (std::abs(r - m_SafeRow) <= 1 && std::abs(c - m_SafeCol) <= 1))
+    {
+        return false;
+    }
+    uint64_t h = Util::mix(m_Seed ^ Util::mix(
+        (static_cast<uint64_t>(static_cast<uint32_t>(r)) << 32)
+        | static_cast<uint32_t>(c)));
+    return static_cast<uint32_t>(h >> 32) < m_Threshold;
+}
+
+InfiniteBoard::CellValue InfiniteBoard::countMines(Coord r, Coord c) const
+{
+    if (isMine(r, c))
+    {
+        return Board::Cell::MINE;
+    }
+
+    CellValue n = 0;
+    for (Coord i = -1; i <= 1; i ++)
+    {
+        for (Coord j = -1; j <= 1; j ++)
+        {
+            if ((i != 0 || j != 0) && isMine(r + i, c + j))
+            {
+                n ++;
+            }
+        }
+    }
+    return n;
+}
+
+const InfiniteBoard::Chunk *InfiniteBoard::findChunk(Coord r, Coord c) const
+{
+    auto it = m_Chunks.find(getChunkKey(r, c));
+    return it == m_Chunks.end() ? nullptr : it->second.get();
+}
+
+InfiniteBoard::Chunk &InfiniteBoard::touchChunk(Coord r, Coord c)
+{
+    ChunkKey key = getChunkKey(r, c);
+    std::unique_ptr<Chunk> &chunk = m_Chunks[key];
+    if (chunk == nullptr)
+    {
+        chunk.reset(new Chunk);
+        for (CellState &s : chunk->states)
+        {
+            s = Board::Cell::HIDDEN;
+        }
+        initChunkValues(key, *chunk);
+    }
+    return *chunk;
+}
+
+void InfiniteBoard::initChunkValues(ChunkKey key, Chunk &chunk) const
+{
+    Coord r0 = static_cast<int32_t>(static_cast<uint32_t>(key >> 32)) * CHUNK_SIZE;
+    Coord c0 = static_cast<int32_t>(static_cast<uint32_t>(key)) * CHUNK_SIZE;
+
+    for (Coord i = 0; i < CHUNK_SIZE; i ++)
+    {
+        for (Coord j = 0; j < CHUNK_SIZE; j ++)
+        {
+            chunk.values[i * CHUNK_SIZE + j] = countMines(r0 + i, c0 + j);
+        }
+    }
+}
+
+InfiniteBoard::CellState InfiniteBoard::getState(Coord r, Coord c) const
+{
+    const Chunk *chunk = findChunk(r, c);
+    return chunk == nullptr ? Board::Cell::HIDDEN
+                            : chunk->states[getChunkIndex(r, c)];
+}
+
+InfiniteBoard::CellValue InfiniteBoard::getValue(Coord r, Coord c) const
+{
+    const Chunk *chunk = findChunk(r, c);
+    return chunk == nullptr ? countMines(r, c)
+                            : chunk->values[getChunkIndex(r, c)];
+}
+
+void InfiniteBoard::open(Coord r, Coord c)
+{
+    if (m_State == LOST)
+    {
+        return;
+    }
+
+    CellState state = getState(r, c);
+    if (state == Board::Cell::FLAGGED || state == Board::Cell::UNKNOWN)
+    {
+        return;
+    }
+
+    if (m_State == INIT)
+    {
+        m_SafeRow = r;
+        m_SafeCol = c;
+        m_State = PLAYING;
+        for (auto &kv : m_Chunks)
+        {
+            initChunkValues(kv.first, *kv.second);
+        }
+        m_Timer.start();
+    }
+
+    // The flood fill can cover an arbitrarily large area, so it keeps its
+    // own stack instead of recursing.
+    std::vector<std::pair<Coord, Coord>> stack;
+    stack.emplace_back(r, c);
+
+    while (!stack.empty())
+    {
+        Coord y = stack.back().first;
+        Coord x = stack.back().second;
+        stack.pop_back();
+
+        Chunk &chunk = touchChunk(y, x);
+        size_t idx = getChunkIndex(y, x);
+        if (chunk.states[idx] != Board::Cell::SHOWN)
+        {
+            chunk.states[idx] = Board::Cell::SHOWN;
+            m_NOpened ++;
+        }
+
+        CellValue value = chunk.values[idx];
+        if (value == Board::Cell::MINE)
+        {
+            m_State = LOST;
+            m_Timer.stop();
+            return;
+        }
+
+        CellValue nMineFound = 0;
+        for (Coord i = -1; i <= 1; i ++)
+        {
+            for (Coord j = -1; j <= 1; j ++)
+            {
+                if ((i != 0 || j != 0)
+                    && getState(y + i, x + j) == Board::Cell::FLAGGED)
+                {
+                    nMineFound ++;
+                }
+            }
+        }
+
+        if (nMineFound < value)
+        {
+            continue;
+        }
+
+        for (Coord i = -1; i <= 1; i ++)
+        {
+            for (Coord j = -1; j <= 1; j ++)
+            {
+                CellState s = getState(y + i, x + j);
+                if ((i != 0 || j != 0)
+                    && s != Board::Cell::SHOWN && s != Board::Cell::FLAGGED)
+                {
+                    stack.emplace_back(y + i, x + j);
+                }
+            }
+        }
+    }
+}
+
+void InfiniteBoard::nextState(Coord r, Coord c)
+{
+    if (m_State == LOST)
+    {
+        return;
+    }
+
+    Chunk &chunk = touchChunk(r, c);
+    CellState &state = chunk.states[getChunkIndex(r, c)];
+
+    switch (state)
+    {
+        case Board::Cell::HIDDEN:
+            state = Board::Cell::FLAGGED;
+            m_NFlagged ++;
+            break;
+        case Board::Cell::FLAGGED:
+            state = Board::Cell::UNKNOWN;
+            m_NFlagged --;
+            break;
+        case Board::Cell::UNKNOWN:
+            state = Board::Cell::HIDDEN;
+            break;
+        default:
+            break;
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef CANH_INFINITE_BOARD_H
+#define CANH_INFINITE_BOARD_H
+
+#include "board.h"
+#include "timer.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+
+// An unbounded board. Cells live in fixed-size chunks that are allocated the
+// first time they are touched, so memory follows the explored area. Whether a
+// cell is a mine is a pure function of the seed and its coordinate, which lets
+// a chunk compute its border values without generating its neighbours.
+class InfiniteBoard
+{
+public:
+    typedef int32_t Coord;
+    typedef uint64_t Seed;
+    typedef Board::Cell::State CellState;
+    typedef Board::Cell::Value CellValue;
+
+    static const Coord CHUNK_SIZE = 32;
+
+    // With fewer mines the zero cells form regions without end, so a single
+    // open could flood forever
+    static constexpr double MIN_DENSITY = 0.12;
+
+    enum State
+    {
+        INIT,
+        PLAYING,
+        LOST
+    };
+
+    // density is the share of mines, from MIN_DENSITY up to but excluding 1
+    InfiniteBoard(double density, Seed seed);
+
+    CellState getState(Coord r, Coord c) const;
+    CellValue getValue(Coord r, Coord c) const;
+
+    bool isLost() const { return m_State == LOST; }
+
+    Seed getSeed() const { return m_Seed; }
+    size_t getNOpened() const { return m_NOpened; }
+    size_t getNFlagged() const { return m_NFlagged; }
+    size_t getNChunks() const { return m_Chunks.size(); }
+
+    Timer::Sec getElapsedSec() const { return m_Timer.getSecond(); }
+
+    bool isMine(Coord r, Coord c) const;
+
+    void open(Coord r, Coord c);
+    void nextState(Coord r, Coord c);
+
+private:
+    struct Chunk
+    {
+        CellState states[CHUNK_SIZE * CHUNK_SIZE];
+        CellValue values[CHUNK_SIZE * CHUNK_SIZE];
+    };
+
+    typedef uint64_t ChunkKey;
+
+    State m_State;
+    uint32_t m_Threshold;
+    Seed m_Seed;
+    Coord m_SafeRow;
+    Coord m_SafeCol;
+    size_t m_NOpened;
+    size_t m_NFlagged;
+    Timer m_Timer;
+
+    std::unordered_map<ChunkKey, std::unique_ptr<Chunk>> m_Chunks;
+
+    static ChunkKey getChunkKey(Coord r, Coord c);
+    static size_t getChunkIndex(Coord r, Coord c);
+
+    const Chunk *findChunk(Coord r, Coord c) const;
+    Chunk &touchChunk(Coord r, Coord c);
+    void initChunkValues(ChunkKey key, Chunk &chunk) const;
+
+    CellValue countMines(Coord r, Coord c) const;
+};
+
+#endif
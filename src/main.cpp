@@ -1,23 +1,125 @@
 #include "board.h"
+#include "game_stats.h"
+#include "game_view.h"
 #include "graphic.h"
+#include "move_log.h"
+#include "terminal.h"
+#include "util.h"
 
 #include <cstdint>
 #include <cstdlib>
+#include <iostream>
+#include <string>
 
-const Board::Size N_ROWS = 9;
-const Board::Size N_COLS = 9;
-const Board::Size N_MINES = 10;
+const Board::Size DEFAULT_N_ROWS = 9;
+const Board::Size DEFAULT_N_COLS = 9;
+const Board::Size DEFAULT_N_MINES = 10;
+const Board::Size N_LAYERS = Board::Topology::LAYERED ? 3 : 1;
+const double INFINITE_DENSITY = 0.15;
 
 const Graphic::Size WINDOW_WIDTH_UNIT = 32;
 const Graphic::Size WINDOW_HEIGHT_UNIT = 32;
 
 
 int main(int argc, char *argv[]) {
+    Util::getStartTime();
+
+    bool infinite = false;
+    bool tty = false;
+    std::string statsPath;
+    std::string movesPath;
+    int nRows = DEFAULT_N_ROWS;
+    int nCols = DEFAULT_N_COLS;
+    int nMines = DEFAULT_N_MINES;
+    for (int i = 1; i < argc; i ++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--infinite")
+        {
+            infinite = true;
+        }
+        else if (arg == "--tty")
+        {
+            tty = true;
+        }
+        else if (arg == "--stats" && i + 1 < argc)
+        {
+            statsPath = argv[++ i];
+        }
+        else if (arg == "--moves" && i + 1 < argc)
+        {
+            movesPath = argv[++ i];
+        }
+        else if (arg == "--rows" && i + 1 < argc)
+        {
+            nRows = std::atoi(argv[++ i]);
+        }
+        else if (arg == "--cols" && i + 1 < argc)
+        {
+            nCols = std::atoi(argv[++ i]);
+        }
+        else if (arg == "--mines" && i + 1 < argc)
+        {
+            nMines = std::atoi(argv[++ i]);
+        }
+    }
+
+    // Sizes go to the statistics file in 16 bits, and the first click must
+    // have a safe cell
+    long nCells = static_cast<long>(N_LAYERS) * nRows * nCols;
+    if (nRows < 3 || nCols < 3 || nRows > UINT16_MAX
+        || nCols * N_LAYERS > UINT16_MAX || nCells > Board::MAX_N_CELLS
+        || nMines < 0 || nMines > UINT16_MAX || nMines >= nCells)
+    {
+        std::cerr << "Invalid board size" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const Board::Size N_ROWS = static_cast<Board::Size>(nRows);
+    const Board::Size N_COLS = static_cast<Board::Size>(nCols);
+    const Board::Size N_MINES = static_cast<Board::Size>(nMines);
+
+    if (tty)
+    {
+        if (infinite)
+        {
+            std::cerr << "The terminal plays finite boards only" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        try
+        {
+            Terminal terminal;
+            GameView view(terminal, N_ROWS, N_COLS, N_MINES, N_LAYERS,
+                statsPath, movesPath);
+            view.loop();
+        }
+        catch (Terminal::Exception &e)
+        {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        catch (GameStats::Exception &e)
+        {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        catch (MoveLog::Exception &e)
+        {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    Dims layout = {N_LAYERS, nRows, nCols};
+
     Graphic::Rect boardRect = {
         0,
         static_cast<Graphic::Pos>(4 * WINDOW_HEIGHT_UNIT),
-        static_cast<Graphic::Pos>(N_COLS * WINDOW_WIDTH_UNIT),
-        static_cast<Graphic::Pos>(N_ROWS * WINDOW_HEIGHT_UNIT)
+        static_cast<Graphic::Pos>(infinite ? N_COLS * WINDOW_WIDTH_UNIT
+            : Board::Topology::getLayoutCols(layout) * WINDOW_WIDTH_UNIT),
+        static_cast<Graphic::Pos>(infinite ? N_ROWS * WINDOW_HEIGHT_UNIT
+            : Board::Topology::getLayoutRows(layout) * WINDOW_HEIGHT_UNIT)
     };
 
     Graphic::Rect bannerRect = {
@@ -32,14 +134,36 @@ int main(int argc, char *argv[]) {
     try
     {
         Graphic gui("Minesweeper", windowWidth, windowHeight);
-        gui.createBoard(N_ROWS, N_COLS, N_MINES, boardRect);
-        gui.createBanner(bannerRect);
-        gui.loop();
+        if (infinite)
+        {
+            gui.createInfiniteBoard(N_ROWS, N_COLS, INFINITE_DENSITY,
+                boardRect);
+            gui.createBanner(bannerRect);
+            gui.loop();
+        }
+        else
+        {
+            gui.createBoardView(layout, boardRect);
+            gui.createBanner(bannerRect);
+            GameView view(gui, N_ROWS, N_COLS, N_MINES, N_LAYERS, statsPath,
+                movesPath);
+            view.loop();
+        }
     }
     catch (Graphic::Exception &e)
     {
         Graphic::showError(e.what());
         return EXIT_FAILURE;
     }
+    catch (GameStats::Exception &e)
+    {
+        Graphic::showError(e.what());
+        return EXIT_FAILURE;
+    }
+    catch (MoveLog::Exception &e)
+    {
+        Graphic::showError(e.what());
+        return EXIT_FAILURE;
+    }
     return EXIT_SUCCESS;
 }
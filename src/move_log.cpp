@@ -0,0 +1,95 @@
+#include "move_log.h"
+#include "board.h"
+
+#include <sstream>
+
+MoveLog::MoveLog(const std::string &path)
+    : m_Path(path)
+{
+}
+
+void MoveLog::start(const Board &board)
+{
+    m_Out.close();
+    m_Out.open(m_Path, std::ios::trunc);
+    if (!m_Out)
+    {
+        throw Exception("Can not open \"" + m_Path + "\"!");
+    }
+    m_Out << board.getNLayers() << ' ' << board.getNRows() << ' '
+          << board.getNCols() << ' ' << board.getNMines() << ' '
+          << board.getSeed() << std::endl;
+}
+
+void MoveLog::append(Move move, Board::Pos p)
+{
+    m_Out << static_cast<char>(move);
+    if (move == OPEN || move == NEXT_STATE)
+    {
+        m_Out << ' ' << p;
+    }
+    // Flushed every time, so the file can be read while the game goes on
+    m_Out << std::endl;
+}
+
+std::unique_ptr<Board> MoveLog::replay(const std::string &path)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        throw Exception("Can not open \"" + path + "\"!");
+    }
+
+    long nLayers, nRows, nCols, nMines;
+    Board::Seed seed;
+    std::string line;
+    std::getline(in, line);
+    std::istringstream header(line);
+    if (!(header >> nLayers >> nRows >> nCols >> nMines >> seed)
+        || nLayers <= 0 || nRows <= 0 || nCols <= 0
+        || (nLayers != 1 && !Board::Topology::LAYERED)
+        || nLayers * nRows * nCols > Board::MAX_N_CELLS
+        || nMines < 0 || nMines >= nLayers * nRows * nCols)
+    {
+        throw Exception("\"" + path + "\" is not a move log!");
+    }
+
+    std::unique_ptr<Board> board(new Board(nRows, nCols, nMines, nLayers,
+        seed));
+    for (size_t lineNo = 2; std::getline(in, line); lineNo ++)
+    {
+        std::istringstream fields(line);
+        char move;
+        long p = Board::POS_UNDEFINED;
+        if (!(fields >> move))
+        {
+            continue;
+        }
+        if ((move == OPEN || move == NEXT_STATE)
+            && (!(fields >> p) || p < 0 || p >= board->getNCells()))
+        {
+            throw Exception("Bad position on line "
+                + std::to_string(lineNo) + " of \"" + path + "\"!");
+        }
+
+        switch (move)
+        {
+            case OPEN:
+                board->open(static_cast<Board::Pos>(p));
+                break;
+            case NEXT_STATE:
+                board->nextState(static_cast<Board::Pos>(p));
+                break;
+            case UNDO:
+                board->undo();
+                break;
+            case REDO:
+                board->redo();
+                break;
+            default:
+                throw Exception("Unknown move on line "
+                    + std::to_string(lineNo) + " of \"" + path + "\"!");
+        }
+    }
+    return board;
+}
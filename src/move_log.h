@@ -0,0 +1,51 @@
+#ifndef CANH_MOVE_LOG_H
+#define CANH_MOVE_LOG_H
+
+#include "board.h"
+
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+// A game kept as its board size, its seed and the moves made on it, which is
+// all it takes to rebuild the board: the mines follow from the seed and the
+// first opened cell. The file is text, a header line
+//
+//   LAYERS ROWS COLS MINES SEED
+//
+// and then one move per line: "o POS" (open), "n POS" (next state), "u"
+// (undo) or "r" (redo). Every move is written as soon as it is made, so the
+// file describes a game in progress as well as a finished one.
+class MoveLog
+{
+public:
+    class Exception : public std::runtime_error
+    {
+    public:
+        Exception(const std::string &msg) : std::runtime_error(msg) {}
+    };
+
+    enum Move : char
+    {
+        OPEN = 'o',
+        NEXT_STATE = 'n',
+        UNDO = 'u',
+        REDO = 'r'
+    };
+
+    explicit MoveLog(const std::string &path);
+
+    // Starts the file over for a new game on board
+    void start(const Board &board);
+    void append(Move move, Board::Pos p = Board::POS_UNDEFINED);
+
+    // Plays the moves of the file at path on a new board
+    static std::unique_ptr<Board> replay(const std::string &path);
+
+private:
+    std::string m_Path;
+    std::ofstream m_Out;
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef CANH_RENDERER_H
+#define CANH_RENDERER_H
+
+#include "board.h"
+#include "sprite_atlas.h"
+#include "timer.h"
+#include "topology.h"
+
+#include <cstdint>
+
+// A frontend that a GameView plays through: it draws the board and the
+// banner from SpriteAtlas sprites and maps its own input events to game
+// inputs. A frame is drawBoard(), then drawBanner(), then present().
+class Renderer
+{
+public:
+    struct Input
+    {
+        enum Type
+        {
+            NONE,
+            QUIT,
+            PRESS_CELL,     // held down, drawn pressed until released
+            PRESS_EMOJI,
+            RELEASE,
+            OPEN,
+            NEXT_STATE,
+            RESET,
+            UNDO,
+            REDO
+        };
+
+        Type type;
+        Board::Pos pos;
+    };
+
+    virtual ~Renderer() {}
+
+    // One SpriteAtlas::Sprite per cell, in board order
+    virtual void drawBoard(const Dims &dims, const uint8_t *sprites) = 0;
+    virtual void drawBanner(Board::Size nMinesRemaining, Timer::Sec sec,
+        SpriteAtlas::Sprite emoji) = 0;
+    virtual void present() = 0;
+
+    // Waits up to timeoutMs for an event and returns false if none came.
+    // Events that mean nothing to the game, such as moving a cursor, come
+    // back as NONE so that the frame is still redrawn.
+    virtual bool pollInput(Input &input, int timeoutMs) = 0;
+};
+
+#endif
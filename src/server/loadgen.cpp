@@ -0,0 +1,351 @@
+#include "protocol.h"
+#include "board.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Load generator for minesweeper-server. Every connection runs on its own
+// thread, plays random opens on its sessions with a fixed number of requests
+// in flight and restarts games as they end. Only opens that change a board
+// count as moves: opens still in flight when their game ended come back
+// without changes. Reports move latency percentiles and the move rate.
+
+typedef std::chrono::steady_clock Clock;
+
+struct Options
+{
+    std::string unixPath;
+    uint16_t port;
+    unsigned nConnections;
+    unsigned nSessions;
+    unsigned depth;
+    unsigned seconds;
+    uint16_t nRows;
+    uint16_t nCols;
+    uint16_t nMines;
+};
+
+class Client
+{
+public:
+    Client(const Options &options)
+        : m_Options(options), m_Fd(-1), m_InOffset(0) {}
+    ~Client()
+    {
+        if (m_Fd >= 0)
+        {
+            close(m_Fd);
+        }
+    }
+
+    bool connect();
+    void run(Clock::time_point deadline);
+
+    const std::vector<uint32_t> &getLatencies() const { return m_Latencies; }
+
+private:
+    struct Pending
+    {
+        Clock::time_point sent;
+        bool move;
+        size_t session;
+    };
+
+    const Options &m_Options;
+    int m_Fd;
+    std::vector<uint8_t> m_Out;
+    std::vector<uint8_t> m_In;
+    size_t m_InOffset;
+    std::deque<Pending> m_Pending;
+    std::vector<uint32_t> m_Sessions;
+    // Whether a RESET is in flight for the session, so a game that ended is
+    // reset once however many of its opens were still pending
+    std::vector<bool> m_Resetting;
+    std::vector<uint32_t> m_Latencies;
+
+    bool send();
+    bool receive(std::vector<uint8_t> &body);
+};
+
+bool Client::connect()
+{
+    if (m_Options.unixPath.empty())
+    {
+        m_Fd = socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(m_Fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(m_Options.port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        return ::connect(m_Fd, reinterpret_cast<sockaddr *>(&addr),
+            sizeof(addr)) == 0;
+    }
+
+    m_Fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, m_Options.unixPath.c_str(),
+        sizeof(addr.sun_path) - 1);
+    return ::connect(m_Fd, reinterpret_cast<sockaddr *>(&addr),
+        sizeof(addr)) == 0;
+}
+
+bool Client::send()
+{
+    size_t offset = 0;
+    while (offset < m_Out.size())
+    {
+        ssize_t n = ::send(m_Fd, m_Out.data() + offset, m_Out.size() - offset,
+            MSG_NOSIGNAL);
+        if (n <= 0)
+        {
+            return false;
+        }
+        offset += n;
+    }
+    m_Out.clear();
+    return true;
+}
+
+bool Client::receive(std::vector<uint8_t> &body)
+{
+    while (true)
+    {
+        const uint8_t *data = m_In.data() + m_InOffset;
+        size_t frameSize = Protocol::getFrameSize(data,
+            m_In.size() - m_InOffset);
+        if (frameSize == SIZE_MAX)
+        {
+            return false;
+        }
+        if (frameSize != 0)
+        {
+            body.assign(data + 4, data + frameSize);
+            m_InOffset += frameSize;
+            return true;
+        }
+
+        m_In.erase(m_In.begin(), m_In.begin() + m_InOffset);
+        m_InOffset = 0;
+
+        uint8_t buf[64 * 1024];
+        ssize_t n = ::recv(m_Fd, buf, sizeof(buf), 0);
+        if (n <= 0)
+        {
+            return false;
+        }
+        m_In.insert(m_In.end(), buf, buf + n);
+    }
+}
+
+void Client::run(Clock::time_point deadline)
+{
+    std::vector<uint8_t> body;
+
+    for (unsigned i = 0; i < m_Options.nSessions; i ++)
+    {
+        Protocol::Writer w(m_Out);
+        w.u8(Protocol::NEW);
+        w.u16(m_Options.nRows);
+        w.u16(m_Options.nCols);
+        w.u16(m_Options.nMines);
+    }
+    if (!send())
+    {
+        return;
+    }
+    for (unsigned i = 0; i < m_Options.nSessions; i ++)
+    {
+        if (!receive(body))
+        {
+            return;
+        }
+        Protocol::Reader r(body.data(), body.size());
+        if (r.u8() != Protocol::OK)
+        {
+            std::cerr << "Can not create session" << std::endl;
+            return;
+        }
+        m_Sessions.push_back(r.u32());
+    }
+    m_Resetting.assign(m_Sessions.size(), false);
+
+    std::default_random_engine rng(std::random_device{}());
+    std::uniform_int_distribution<uint16_t> randomPos(0,
+        m_Options.nRows * m_Options.nCols - 1);
+    size_t next = 0;
+
+    while (true)
+    {
+        bool running = Clock::now() < deadline;
+        while (running && m_Pending.size() < m_Options.depth)
+        {
+            size_t session = next ++ % m_Sessions.size();
+            Protocol::Writer w(m_Out);
+            w.u8(Protocol::OPEN);
+            w.u32(m_Sessions[session]);
+            w.u16(randomPos(rng));
+            m_Pending.push_back({Clock::now(), true, session});
+        }
+        if (!send())
+        {
+            return;
+        }
+        if (m_Pending.empty())
+        {
+            return;
+        }
+
+        if (!receive(body))
+        {
+            return;
+        }
+        Clock::time_point received = Clock::now();
+        Pending pending = m_Pending.front();
+        m_Pending.pop_front();
+        if (!pending.move)
+        {
+            m_Resetting[pending.session] = false;
+            continue;
+        }
+
+        Protocol::Reader r(body.data(), body.size());
+        if (r.u8() != Protocol::OK)
+        {
+            continue;
+        }
+        uint8_t state = r.u8();
+        if (r.u32() != 0)
+        {
+            m_Latencies.push_back(static_cast<uint32_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    received - pending.sent).count()));
+        }
+        if (running && !m_Resetting[pending.session]
+            && (state == Board::WON || state == Board::LOST))
+        {
+            Protocol::Writer w(m_Out);
+            w.u8(Protocol::RESET);
+            w.u32(m_Sessions[pending.session]);
+            m_Pending.push_back({Clock::now(), false, pending.session});
+            m_Resetting[pending.session] = true;
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Options options = {"", 7777, 4, 64, 16, 10, 16, 30, 99};
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string arg = argv[i];
+        unsigned value = std::atoi(argv[i + 1]);
+        if (arg == "--unix")
+        {
+            options.unixPath = argv[i + 1];
+        }
+        else if (arg == "--port")
+        {
+            options.port = static_cast<uint16_t>(value);
+        }
+        else if (arg == "--connections")
+        {
+            options.nConnections = std::max(1u, value);
+        }
+        else if (arg == "--sessions")
+        {
+            options.nSessions = std::max(1u, value);
+        }
+        else if (arg == "--depth")
+        {
+            options.depth = std::max(1u, value);
+        }
+        else if (arg == "--seconds")
+        {
+            options.seconds = value;
+        }
+        else if (arg == "--rows")
+        {
+            options.nRows = static_cast<uint16_t>(value);
+        }
+        else if (arg == "--cols")
+        {
+            options.nCols = static_cast<uint16_t>(value);
+        }
+        else if (arg == "--mines")
+        {
+            options.nMines = static_cast<uint16_t>(value);
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--unix PATH | --port PORT]"
+                      << " [--connections N] [--sessions N] [--depth N]"
+                      << " [--seconds N] [--rows N] [--cols N] [--mines N]"
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<std::unique_ptr<Client>> clients;
+    for (unsigned i = 0; i < options.nConnections; i ++)
+    {
+        clients.emplace_back(new Client(options));
+        if (!clients.back()->connect())
+        {
+            std::cerr << "Can not connect to server" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    Clock::time_point start = Clock::now();
+    Clock::time_point deadline = start + std::chrono::seconds(options.seconds);
+    std::vector<std::thread> threads;
+    for (auto &client : clients)
+    {
+        threads.emplace_back(&Client::run, client.get(), deadline);
+    }
+    for (std::thread &t : threads)
+    {
+        t.join();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<uint32_t> latencies;
+    for (auto &client : clients)
+    {
+        latencies.insert(latencies.end(), client->getLatencies().begin(),
+            client->getLatencies().end());
+    }
+    if (latencies.empty())
+    {
+        std::cerr << "No moves completed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << "moves:      " << latencies.size() << std::endl
+              << "moves/sec:  " << static_cast<uint64_t>(latencies.size()
+                                                         / elapsed) << std::endl
+              << "p50 (us):   " << latencies[latencies.size() / 2] << std::endl
+              << "p99 (us):   " << latencies[latencies.size() * 99 / 100]
+              << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,67 @@
+#include "server.h"
+
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+const uint16_t DEFAULT_PORT = 7777;
+
+Server *g_Server = nullptr;
+
+void handleSignal(int)
+{
+    if (g_Server != nullptr)
+    {
+        g_Server->stop();
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Server::Config config = {"", DEFAULT_PORT,
+        std::max(1u, std::thread::hardware_concurrency())};
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string arg = argv[i];
+        if (arg == "--unix")
+        {
+            config.unixPath = argv[i + 1];
+        }
+        else if (arg == "--port")
+        {
+            config.port = static_cast<uint16_t>(std::atoi(argv[i + 1]));
+        }
+        else if (arg == "--workers")
+        {
+            config.nWorkers = std::atoi(argv[i + 1]);
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--unix PATH | --port PORT] [--workers N]"
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    try
+    {
+        Server server(config);
+        g_Server = &server;
+        std::signal(SIGINT, handleSignal);
+        std::signal(SIGTERM, handleSignal);
+
+        server.run();
+        g_Server = nullptr;
+    }
+    catch (Server::Exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
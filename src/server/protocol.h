@@ -0,0 +1,138 @@
+#ifndef CANH_PROTOCOL_H
+#define CANH_PROTOCOL_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Binary protocol of minesweeper-server. Every message is a frame made of a
+// little-endian u32 body length followed by the body. Clients may pipeline
+// any number of requests; responses come back in request order.
+//
+// Request bodies start with an Op byte:
+//   NEW    u16 rows, u16 cols, u16 mines     -> u32 session
+//   OPEN   u32 session, i16 pos              -> u8 state, u32 n, n x Change
+//   FLAG   u32 session, i16 pos              -> u8 state, u32 n, n x Change
+//   BATCH  u32 session, u16 n, n x (u8 type, i16 pos)
+//                                            -> u8 state, u32 n, n x Change
+//   QUERY  u32 session                       -> u8 state, u16 rows, u16 cols,
+//                                               u16 mines left, cells x u8
+//   RESET  u32 session                       -> (empty)
+//   CLOSE  u32 session                       -> (empty)
+//
+// Response bodies start with a Status byte; the payload above follows only
+// when it is OK. A state is a Board::State: INIT until the first open
+// places the mines, then PLAYING, WON or LOST. A Change is an i16 position
+// and a packed cell byte, and a packed cell holds the cell state in the high
+// nibble and, once shown, its value in the low nibble.
+class Protocol
+{
+public:
+    enum Op
+    {
+        NEW = 1,
+        OPEN,
+        FLAG,
+        BATCH,
+        QUERY,
+        RESET,
+        CLOSE
+    };
+
+    enum Status
+    {
+        OK = 0,
+        BAD_REQUEST,
+        NO_SESSION
+    };
+
+    static const uint32_t MAX_FRAME = 1 << 20;
+    static const uint8_t VALUE_HIDDEN = 0x0F;
+
+    class Writer
+    {
+    public:
+        // Starts a frame at the end of buf, finished by the destructor
+        Writer(std::vector<uint8_t> &buf) : m_Buf(buf), m_Start(buf.size())
+        {
+            u32(0);
+        }
+        ~Writer()
+        {
+            uint32_t len = static_cast<uint32_t>(m_Buf.size() - m_Start - 4);
+            for (unsigned i = 0; i < 4; i ++)
+            {
+                m_Buf[m_Start + i] = static_cast<uint8_t>(len >> (8 * i));
+            }
+        }
+
+        void u8(uint8_t v) { m_Buf.push_back(v); }
+        void u16(uint16_t v)
+        {
+            m_Buf.push_back(static_cast<uint8_t>(v));
+            m_Buf.push_back(static_cast<uint8_t>(v >> 8));
+        }
+        void u32(uint32_t v)
+        {
+            u16(static_cast<uint16_t>(v));
+            u16(static_cast<uint16_t>(v >> 16));
+        }
+
+    private:
+        std::vector<uint8_t> &m_Buf;
+        size_t m_Start;
+    };
+
+    class Reader
+    {
+    public:
+        Reader(const uint8_t *data, size_t size)
+            : m_Cur(data), m_End(data + size), m_Ok(true) {}
+
+        bool ok() const { return m_Ok; }
+        size_t remaining() const { return m_End - m_Cur; }
+
+        uint8_t u8()
+        {
+            if (m_Cur + 1 > m_End)
+            {
+                m_Ok = false;
+                return 0;
+            }
+            return *m_Cur ++;
+        }
+        uint16_t u16()
+        {
+            uint16_t lo = u8();
+            return static_cast<uint16_t>(lo | (u8() << 8));
+        }
+        uint32_t u32()
+        {
+            uint32_t lo = u16();
+            return lo | (static_cast<uint32_t>(u16()) << 16);
+        }
+
+    private:
+        const uint8_t *m_Cur;
+        const uint8_t *m_End;
+        bool m_Ok;
+    };
+
+    // Returns the size of the first complete frame in [data, data + size),
+    // 0 if more bytes are needed, or SIZE_MAX if the frame is too large.
+    static size_t getFrameSize(const uint8_t *data, size_t size)
+    {
+        if (size < 4)
+        {
+            return 0;
+        }
+        uint32_t len = Reader(data, 4).u32();
+        if (len > MAX_FRAME)
+        {
+            return SIZE_MAX;
+        }
+        return size < 4 + len ? 0 : 4 + len;
+    }
+};
+
+#endif
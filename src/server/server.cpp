@@ -0,0 +1,607 @@
+#include "server.h"
+#include "protocol.h"
+#include "board.h"
+#include "util.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace
+{
+    const int MAX_EVENTS = 256;
+    const size_t READ_SIZE = 64 * 1024;
+
+    // Reads from a connection pause while this much output is unsent, so a
+    // client that pipelines without reading can not grow it without bound
+    const size_t MAX_BACKLOG = 4 * Protocol::MAX_FRAME;
+
+    // Session IDs carry the worker in their top byte
+    const uint32_t MAX_SESSIONS = 0xFFFFFF;
+
+    uint8_t packCell(const Board &board, Board::Pos p)
+    {
+        Board::Cell::State state = board.getState(p);
+        uint8_t value = state == Board::Cell::SHOWN
+            ? board.getValue(p) : Protocol::VALUE_HIDDEN;
+        return static_cast<uint8_t>(state << 4 | value);
+    }
+}
+
+class Server::Worker
+{
+public:
+    Worker(unsigned id, int listenFd, int stopFd);
+    ~Worker();
+
+    void start() { m_Thread = std::thread(&Worker::loop, this); }
+    void join() { m_Thread.join(); }
+
+private:
+    struct Connection
+    {
+        int fd;
+        std::vector<uint8_t> in;
+        std::vector<uint8_t> out;
+        size_t outOffset;
+        uint32_t events;        // what epoll currently watches for
+        bool eof;               // the peer will send nothing more
+        std::vector<uint32_t> sessions;
+
+        size_t getBacklog() const { return out.size() - outOffset; }
+    };
+
+    unsigned m_Id;
+    int m_ListenFd;
+    int m_StopFd;
+    int m_EpollFd;
+    uint32_t m_NextSession;
+    std::thread m_Thread;
+    std::vector<uint8_t> m_ReadBuf;
+
+    std::unordered_map<int, std::unique_ptr<Connection>> m_Connections;
+    std::unordered_map<uint32_t, std::unique_ptr<Board>> m_Sessions;
+
+    void loop();
+    void accept();
+    void close(Connection &conn);
+    bool read(Connection &conn);
+    bool serve(Connection &conn);
+    bool answer(Connection &conn, bool &blocked);
+    bool flush(Connection &conn);
+
+    void handleFrame(Connection &conn, const uint8_t *body, size_t size);
+    void writeDelta(Protocol::Writer &w, const Board &board,
+        const Board::Delta &delta) const;
+};
+
+Server::Worker::Worker(unsigned id, int listenFd, int stopFd)
+    : m_Id(id),
+    m_ListenFd(listenFd),
+    m_StopFd(stopFd),
+    m_EpollFd(epoll_create1(EPOLL_CLOEXEC)),
+    m_NextSession(0),
+    m_ReadBuf(READ_SIZE)
+{
+    if (m_EpollFd < 0)
+    {
+        throw Exception("Can not create epoll instance!");
+    }
+
+    // EPOLLEXCLUSIVE wakes a single worker per incoming connection
+    epoll_event ev = {};
+    ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+    ev.data.fd = m_ListenFd;
+    bool ok = epoll_ctl(m_EpollFd, EPOLL_CTL_ADD, m_ListenFd, &ev) == 0;
+
+    ev.events = EPOLLIN;
+    ev.data.fd = m_StopFd;
+    ok = ok && epoll_ctl(m_EpollFd, EPOLL_CTL_ADD, m_StopFd, &ev) == 0;
+    if (!ok)
+    {
+        // The destructor does not run for a throwing constructor
+        ::close(m_EpollFd);
+        throw Exception("Can not watch listening socket!");
+    }
+}
+
+Server::Worker::~Worker()
+{
+    for (auto &kv : m_Connections)
+    {
+        ::close(kv.first);
+    }
+    ::close(m_EpollFd);
+}
+
+void Server::Worker::loop()
+{
+    epoll_event events[MAX_EVENTS];
+
+    while (true)
+    {
+        int n = epoll_wait(m_EpollFd, events, MAX_EVENTS, -1);
+        if (n < 0 && errno != EINTR)
+        {
+            LOG("epoll_wait: " << std::strerror(errno));
+            return;
+        }
+
+        for (int i = 0; i < n; i ++)
+        {
+            int fd = events[i].data.fd;
+            if (fd == m_StopFd)
+            {
+                return;
+            }
+            if (fd == m_ListenFd)
+            {
+                accept();
+                continue;
+            }
+
+            auto it = m_Connections.find(fd);
+            if (it == m_Connections.end())
+            {
+                continue;
+            }
+            Connection &conn = *it->second;
+
+            bool alive = !(events[i].events & (EPOLLERR | EPOLLHUP));
+            if (alive && (events[i].events & EPOLLIN))
+            {
+                alive = read(conn);
+            }
+            if (alive)
+            {
+                alive = serve(conn);
+            }
+            if (!alive)
+            {
+                close(conn);
+            }
+        }
+    }
+}
+
+void Server::Worker::accept()
+{
+    while (true)
+    {
+        int fd = accept4(m_ListenFd, nullptr, nullptr,
+            SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            {
+                LOG("accept: " << std::strerror(errno));
+            }
+            return;
+        }
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        epoll_event ev = {};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = fd;
+        if (epoll_ctl(m_EpollFd, EPOLL_CTL_ADD, fd, &ev) < 0)
+        {
+            ::close(fd);
+            continue;
+        }
+        m_Connections[fd].reset(new Connection{fd, {}, {}, 0, ev.events,
+            false, {}});
+    }
+}
+
+void Server::Worker::close(Connection &conn)
+{
+    for (uint32_t session : conn.sessions)
+    {
+        m_Sessions.erase(session);
+    }
+
+    int fd = conn.fd;
+    epoll_ctl(m_EpollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    m_Connections.erase(fd);
+}
+
+bool Server::Worker::read(Connection &conn)
+{
+    // Leave the rest in the socket until the buffered frames are answered
+    while (conn.in.size() < MAX_BACKLOG)
+    {
+        ssize_t n = ::read(conn.fd, m_ReadBuf.data(), m_ReadBuf.size());
+        if (n > 0)
+        {
+            conn.in.insert(conn.in.end(), m_ReadBuf.data(),
+                m_ReadBuf.data() + n);
+            continue;
+        }
+        if (n == 0)
+        {
+            conn.eof = true;
+            break;
+        }
+        if (errno == EINTR)
+        {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            return false;
+        }
+        break;
+    }
+    return true;
+}
+
+bool Server::Worker::serve(Connection &conn)
+{
+    while (true)
+    {
+        bool blocked = false;
+        if (!answer(conn, blocked) || !flush(conn))
+        {
+            return false;
+        }
+        if (blocked && conn.getBacklog() < MAX_BACKLOG)
+        {
+            // The socket took enough to go on without waiting for EPOLLOUT
+            continue;
+        }
+
+        // A client that shut down its side still gets every answer, and
+        // the connection closes once they are sent
+        return !conn.eof || blocked || conn.getBacklog() > 0;
+    }
+}
+
+bool Server::Worker::answer(Connection &conn, bool &blocked)
+{
+    // Answer the complete frames that arrived, in order, until the output
+    // backlog is full
+    size_t offset = 0;
+    while (true)
+    {
+        if (conn.getBacklog() >= MAX_BACKLOG)
+        {
+            blocked = true;
+            break;
+        }
+        size_t frameSize = Protocol::getFrameSize(conn.in.data() + offset,
+            conn.in.size() - offset);
+        if (frameSize == SIZE_MAX)
+        {
+            return false;
+        }
+        if (frameSize == 0)
+        {
+            break;
+        }
+        handleFrame(conn, conn.in.data() + offset + 4, frameSize - 4);
+        offset += frameSize;
+    }
+    conn.in.erase(conn.in.begin(), conn.in.begin() + offset);
+    return true;
+}
+
+bool Server::Worker::flush(Connection &conn)
+{
+    while (conn.outOffset < conn.out.size())
+    {
+        ssize_t n = ::send(conn.fd, conn.out.data() + conn.outOffset,
+            conn.out.size() - conn.outOffset, MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                return false;
+            }
+            break;
+        }
+        conn.outOffset += n;
+    }
+
+    bool pending = conn.getBacklog() > 0;
+    if (!pending)
+    {
+        conn.out.clear();
+        conn.outOffset = 0;
+    }
+
+    // Input is watched only while there is room to answer it
+    uint32_t events = pending ? EPOLLOUT : 0;
+    if (!conn.eof && conn.getBacklog() < MAX_BACKLOG)
+    {
+        events |= EPOLLIN | EPOLLRDHUP;
+    }
+    if (events != conn.events)
+    {
+        epoll_event ev = {};
+        ev.events = events;
+        ev.data.fd = conn.fd;
+        epoll_ctl(m_EpollFd, EPOLL_CTL_MOD, conn.fd, &ev);
+        conn.events = events;
+    }
+    return true;
+}
+
+void Server::Worker::writeDelta(Protocol::Writer &w, const Board &board,
+    const Board::Delta &delta) const
+{
+    w.u8(Protocol::OK);
+    w.u8(delta.after);
+    w.u32(static_cast<uint32_t>(delta.changed.size()));
+    for (Board::Pos p : delta.changed)
+    {
+        w.u16(static_cast<uint16_t>(p));
+        w.u8(packCell(board, p));
+    }
+}
+
+void Server::Worker::handleFrame(Connection &conn, const uint8_t *body,
+    size_t size)
+{
+    Protocol::Reader r(body, size);
+    Protocol::Writer w(conn.out);
+
+    uint8_t op = r.u8();
+    if (op == Protocol::NEW)
+    {
+        Board::Size nRows = r.u16();
+        Board::Size nCols = r.u16();
+        Board::Size nMines = r.u16();
+        // Positions travel as 16-bit integers
+        uint32_t nCells = static_cast<uint32_t>(nRows) * nCols;
+        if (!r.ok() || nCells == 0 || nCells > INT16_MAX || nMines >= nCells)
+        {
+            w.u8(Protocol::BAD_REQUEST);
+            return;
+        }
+
+        if (m_Sessions.size() >= MAX_SESSIONS)
+        {
+            w.u8(Protocol::BAD_REQUEST);
+            return;
+        }
+
+        // The counter wraps, so skip IDs of sessions that are still open
+        uint32_t session;
+        do
+        {
+            session = (m_Id << 24) | (m_NextSession ++ & MAX_SESSIONS);
+        }
+        while (m_Sessions.count(session) != 0);
+        m_Sessions[session].reset(new Board(nRows, nCols, nMines));
+        conn.sessions.push_back(session);
+        w.u8(Protocol::OK);
+        w.u32(session);
+        return;
+    }
+
+    auto it = m_Sessions.find(r.u32());
+    if (!r.ok())
+    {
+        w.u8(Protocol::BAD_REQUEST);
+        return;
+    }
+    if (it == m_Sessions.end())
+    {
+        w.u8(Protocol::NO_SESSION);
+        return;
+    }
+    Board &board = *it->second;
+
+    switch (op)
+    {
+        case Protocol::OPEN:
+        case Protocol::FLAG:
+        {
+            Board::Command cmd = {
+                op == Protocol::OPEN ? Board::Command::OPEN
+                                     : Board::Command::FLAG,
+                static_cast<Board::Pos>(r.u16())
+            };
+            if (!r.ok() || cmd.pos < 0 || cmd.pos >= board.getNCells())
+            {
+                w.u8(Protocol::BAD_REQUEST);
+                return;
+            }
+            writeDelta(w, board, board.apply(&cmd, 1));
+            return;
+        }
+        case Protocol::BATCH:
+        {
+            std::vector<Board::Command> cmds(r.u16());
+            for (Board::Command &cmd : cmds)
+            {
+                uint8_t type = r.u8();
+                cmd.pos = static_cast<Board::Pos>(r.u16());
+                if (type > Board::Command::CHORD || cmd.pos < 0
+                    || cmd.pos >= board.getNCells())
+                {
+                    w.u8(Protocol::BAD_REQUEST);
+                    return;
+                }
+                cmd.type = static_cast<Board::Command::Type>(type);
+            }
+            if (!r.ok())
+            {
+                w.u8(Protocol::BAD_REQUEST);
+                return;
+            }
+            writeDelta(w, board, board.apply(cmds.data(), cmds.size()));
+            return;
+        }
+        case Protocol::QUERY:
+            w.u8(Protocol::OK);
+            w.u8(board.getGameState());
+            w.u16(board.getNRows());
+            w.u16(board.getNCols());
+            w.u16(board.getNMinesRemaining());
+            for (Board::Pos p = 0; p < board.getNCells(); p ++)
+            {
+                w.u8(packCell(board, p));
+            }
+            return;
+        case Protocol::RESET:
+            it->second.reset(new Board(board.getNRows(), board.getNCols(),
+                board.getNMines()));
+            w.u8(Protocol::OK);
+            return;
+        case Protocol::CLOSE:
+            conn.sessions.erase(std::remove(conn.sessions.begin(),
+                conn.sessions.end(), it->first), conn.sessions.end());
+            m_Sessions.erase(it);
+            w.u8(Protocol::OK);
+            return;
+        default:
+            w.u8(Protocol::BAD_REQUEST);
+            return;
+    }
+}
+
+Server::Server(const Server::Config &config)
+    : m_Config(config),
+    m_ListenFd(-1),
+    m_StopFd(-1)
+{
+    if (config.nWorkers == 0 || config.nWorkers > 255)
+    {
+        throw Exception("Invalid number of workers!");
+    }
+
+    // The destructor does not run for a throwing constructor, so give back
+    // what was opened before passing the error on
+    try
+    {
+        listen();
+        m_StopFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (m_StopFd < 0)
+        {
+            throw Exception("Can not create stop event!");
+        }
+        for (unsigned i = 0; i < config.nWorkers; i ++)
+        {
+            m_Workers.emplace_back(new Worker(i, m_ListenFd, m_StopFd));
+        }
+    }
+    catch (...)
+    {
+        release();
+        throw;
+    }
+}
+
+Server::~Server()
+{
+    release();
+}
+
+void Server::listen()
+{
+    if (m_Config.unixPath.empty())
+    {
+        m_ListenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK
+            | SOCK_CLOEXEC, 0);
+        if (m_ListenFd < 0)
+        {
+            throw Exception("Can not create socket!");
+        }
+        int one = 1;
+        setsockopt(m_ListenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(m_Config.port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(m_ListenFd, reinterpret_cast<sockaddr *>(&addr),
+            sizeof(addr)) < 0)
+        {
+            throw Exception("Can not bind to port "
+                + std::to_string(m_Config.port) + "!");
+        }
+    }
+    else
+    {
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        if (m_Config.unixPath.size() >= sizeof(addr.sun_path))
+        {
+            throw Exception("Socket path is too long!");
+        }
+        std::strcpy(addr.sun_path, m_Config.unixPath.c_str());
+
+        m_ListenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK
+            | SOCK_CLOEXEC, 0);
+        if (m_ListenFd < 0)
+        {
+            throw Exception("Can not create socket!");
+        }
+        unlink(addr.sun_path);
+        if (bind(m_ListenFd, reinterpret_cast<sockaddr *>(&addr),
+            sizeof(addr)) < 0)
+        {
+            throw Exception("Can not bind to \"" + m_Config.unixPath
+                + "\"!");
+        }
+    }
+
+    if (::listen(m_ListenFd, SOMAXCONN) < 0)
+    {
+        throw Exception("Can not listen!");
+    }
+}
+
+void Server::release()
+{
+    m_Workers.clear();
+    if (m_ListenFd >= 0)
+    {
+        ::close(m_ListenFd);
+        if (!m_Config.unixPath.empty())
+        {
+            unlink(m_Config.unixPath.c_str());
+        }
+    }
+    if (m_StopFd >= 0)
+    {
+        ::close(m_StopFd);
+    }
+}
+
+void Server::run()
+{
+    for (auto &worker : m_Workers)
+    {
+        worker->start();
+    }
+    for (auto &worker : m_Workers)
+    {
+        worker->join();
+    }
+}
+
+void Server::stop()
+{
+    // The eventfd stays readable, so every worker sees it
+    uint64_t one = 1;
+    ssize_t n = write(m_StopFd, &one, sizeof(one));
+    (void) n;
+}
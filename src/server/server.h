@@ -0,0 +1,56 @@
+#ifndef CANH_SERVER_H
+#define CANH_SERVER_H
+
+#include "board.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Hosts many Board sessions behind the binary Protocol. Every worker thread
+// runs its own epoll loop over the shared listening socket and owns the
+// connections it accepts and the sessions created on them, so no lock is
+// taken on the request path. A session lives until it is closed or its
+// connection goes away; requests that reach another worker get NO_SESSION.
+class Server
+{
+public:
+    struct Config
+    {
+        std::string unixPath;   // listen on this Unix socket when not empty
+        uint16_t port;          // otherwise on this TCP port of 127.0.0.1
+        unsigned nWorkers;
+    };
+
+    class Exception : public std::runtime_error
+    {
+    public:
+        Exception(const std::string &msg) : std::runtime_error(msg) {}
+    };
+
+    Server(const Config &config);
+    ~Server();
+
+    // Blocks until stop() is called
+    void run();
+    void stop();
+
+private:
+    class Worker;
+
+    Config m_Config;
+    int m_ListenFd;
+    int m_StopFd;
+    std::vector<std::unique_ptr<Worker>> m_Workers;
+
+    void listen();
+    // Stops the workers and closes what the constructor opened
+    void release();
+};
+
+#endif
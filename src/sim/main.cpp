@@ -0,0 +1,206 @@
+#include "board.h"
+#include "solver.h"
+#include "transposition_table.h"
+#include "util.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Plays many games with the Solver on every hardware thread. All workers
+// share one TranspositionTable, so a pattern solved by one of them is reused
+// by the others. Each deduction is checked against the mines the player
+// never sees; any wrong one makes the run fail.
+
+namespace
+{
+    struct Totals
+    {
+        std::atomic<uint64_t> nGames;
+        std::atomic<uint64_t> nWon;
+        std::atomic<uint64_t> nDeductions;
+        std::atomic<uint64_t> nWrong;
+        std::atomic<uint64_t> nHits;
+        std::atomic<uint64_t> nMisses;
+    };
+
+    // Opens the frontier cell least likely to be a mine, or any hidden cell
+    // when there is no frontier yet
+    Board::Pos guess(const Board &board, const Solver::Analysis &analysis,
+        std::mt19937_64 &rng)
+    {
+        auto best = std::min_element(analysis.probabilities.begin(),
+            analysis.probabilities.end(),
+            [](const std::pair<Board::Pos, float> &a,
+                const std::pair<Board::Pos, float> &b) {
+                return a.second < b.second;
+            });
+        if (best != analysis.probabilities.end())
+        {
+            return best->first;
+        }
+
+        std::vector<Board::Pos> hidden;
+        for (Board::Pos p = 0; p < board.getNCells(); p ++)
+        {
+            if (board.getState(p) == Board::Cell::HIDDEN)
+            {
+                hidden.push_back(p);
+            }
+        }
+        return hidden.empty() ? Board::POS_UNDEFINED
+                              : hidden[rng() % hidden.size()];
+    }
+
+    void play(Board &board, Solver &solver, std::mt19937_64 &rng,
+        Totals &totals)
+    {
+        board.open(board.convertPos(board.getNRows() / 2,
+            board.getNCols() / 2));
+
+        std::vector<Board::Command> commands;
+        while (!board.isWon() && !board.isLost())
+        {
+            const Solver::Analysis &analysis = solver.analyse(board);
+            commands.clear();
+            for (Board::Pos p : analysis.safe)
+            {
+                totals.nWrong += board.getValue(p) == Board::Cell::MINE;
+                commands.push_back({Board::Command::OPEN, p});
+            }
+            for (Board::Pos p : analysis.mines)
+            {
+                totals.nWrong += board.getValue(p) != Board::Cell::MINE;
+                commands.push_back({Board::Command::FLAG, p});
+            }
+            totals.nDeductions += commands.size();
+
+            if (commands.empty())
+            {
+                Board::Pos p = guess(board, analysis, rng);
+                if (p == Board::POS_UNDEFINED)
+                {
+                    break;
+                }
+                commands.push_back({Board::Command::OPEN, p});
+            }
+            board.apply(commands.data(), commands.size());
+        }
+
+        totals.nGames ++;
+        totals.nWon += board.isWon();
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    long nGames = 10000;
+    long nRows = 16;
+    long nCols = 30;
+    long nMines = 99;
+    unsigned nThreads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned log2TableSize = 20;
+    Board::Seed seed = Util::getRNG()();
+    bool valid = true;
+
+    for (int i = 1; valid && i < argc; i += 2)
+    {
+        std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value == nullptr)
+        {
+            valid = false;
+        }
+        else if (arg == "--games")
+        {
+            nGames = std::atol(value);
+        }
+        else if (arg == "--rows")
+        {
+            nRows = std::atol(value);
+        }
+        else if (arg == "--cols")
+        {
+            nCols = std::atol(value);
+        }
+        else if (arg == "--mines")
+        {
+            nMines = std::atol(value);
+        }
+        else if (arg == "--threads")
+        {
+            nThreads = std::max(1, std::atoi(value));
+        }
+        else if (arg == "--table")
+        {
+            log2TableSize = std::atoi(value);
+        }
+        else if (arg == "--seed")
+        {
+            seed = std::strtoull(value, nullptr, 10);
+        }
+        else
+        {
+            valid = false;
+        }
+    }
+
+    if (!valid || nGames <= 0 || nRows <= 0 || nCols <= 0
+        || nRows * nCols > Board::MAX_N_CELLS || nMines < 0
+        || nMines >= nRows * nCols || log2TableSize > 30)
+    {
+        std::cerr << "Usage: " << argv[0] << " [--games N]"
+                  << " [--rows N] [--cols N] [--mines N]"
+                  << " [--threads N] [--table LOG2_SLOTS] [--seed S]"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    TranspositionTable table(log2TableSize);
+    Totals totals = {};
+    std::atomic<long> next(0);
+    auto start = std::chrono::steady_clock::now();
+
+    // Game i is played on seed + i, so a run can be repeated exactly
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < nThreads; t ++)
+    {
+        workers.emplace_back([&]() {
+            Solver solver(table);
+            long i;
+            while ((i = next ++) < nGames)
+            {
+                std::mt19937_64 rng(seed + i);
+                Board board(nRows, nCols, nMines, 1, seed + i);
+                play(board, solver, rng, totals);
+            }
+            totals.nHits += solver.getNHits();
+            totals.nMisses += solver.getNMisses();
+        });
+    }
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    uint64_t nLookups = std::max<uint64_t>(1, totals.nHits + totals.nMisses);
+    std::cout << "games:       " << totals.nGames << std::endl
+              << "won:         " << 100.0 * totals.nWon / totals.nGames
+              << "%" << std::endl
+              << "games/sec:   " << totals.nGames * 1000.0
+                 / std::max<int64_t>(1, ms) << std::endl
+              << "deductions:  " << totals.nDeductions << std::endl
+              << "table hits:  " << 100.0 * totals.nHits / nLookups
+              << "%" << std::endl
+              << "wrong:       " << totals.nWrong << std::endl;
+    return totals.nWrong == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
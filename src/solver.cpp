@@ -0,0 +1,402 @@
+#include "solver.h"
+#include "board.h"
+#include "util.h"
+#include "transposition_table.h"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    const uint64_t MAX_SEARCH_NODES = 1 << 22;
+
+    class Enumerator
+    {
+    public:
+        Enumerator(size_t nCells,
+            const std::vector<std::pair<uint32_t, uint8_t>> &constraints)
+            : m_NCells(nCells),
+            m_CellConstraints(nCells),
+            m_Target(constraints.size()),
+            m_Assigned(constraints.size(), 0),
+            m_Open(constraints.size(), 0),
+            m_Mines(nCells, 0),
+            m_Counts(nCells, 0),
+            m_NSolutions(0),
+            m_NNodes(0)
+        {
+            for (size_t c = 0; c < constraints.size(); c ++)
+            {
+                m_Target[c] = constraints[c].second;
+                for (size_t i = 0; i < nCells; i ++)
+                {
+                    if (constraints[c].first >> i & 1)
+                    {
+                        m_CellConstraints[i].push_back(c);
+                        m_Open[c] ++;
+                    }
+                }
+            }
+        }
+
+        // Returns false when the search was abandoned
+        bool run() { return search(0); }
+
+        uint64_t getNSolutions() const { return m_NSolutions; }
+        uint64_t getCount(size_t i) const { return m_Counts[i]; }
+
+    private:
+        size_t m_NCells;
+        std::vector<std::vector<size_t>> m_CellConstraints;
+        std::vector<int> m_Target;
+        std::vector<int> m_Assigned;
+        std::vector<int> m_Open;
+        std::vector<uint8_t> m_Mines;
+        std::vector<uint64_t> m_Counts;
+        uint64_t m_NSolutions;
+        uint64_t m_NNodes;
+
+        bool search(size_t i)
+        {
+            if (++ m_NNodes > MAX_SEARCH_NODES)
+            {
+                return false;
+            }
+            if (i == m_NCells)
+            {
+                m_NSolutions ++;
+                for (size_t j = 0; j < m_NCells; j ++)
+                {
+                    m_Counts[j] += m_Mines[j];
+                }
+                return true;
+            }
+
+            for (int mine = 0; mine <= 1; mine ++)
+            {
+                bool feasible = true;
+                for (size_t c : m_CellConstraints[i])
+                {
+                    m_Assigned[c] += mine;
+                    m_Open[c] --;
+                    if (m_Assigned[c] > m_Target[c]
+                        || m_Assigned[c] + m_Open[c] < m_Target[c])
+                    {
+                        feasible = false;
+                    }
+                }
+
+                m_Mines[i] = static_cast<uint8_t>(mine);
+                bool completed = !feasible || search(i + 1);
+
+                for (size_t c : m_CellConstraints[i])
+                {
+                    m_Assigned[c] -= mine;
+                    m_Open[c] ++;
+                }
+                if (!completed)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    bool isUnknown(Board::Cell::State state)
+    {
+        return state == Board::Cell::HIDDEN || state == Board::Cell::UNKNOWN;
+    }
+
+    size_t findRoot(std::vector<size_t> &parents, size_t i)
+    {
+        while (parents[i] != i)
+        {
+            parents[i] = parents[parents[i]];
+            i = parents[i];
+        }
+        return i;
+    }
+}
+
+Solver::Solver(TranspositionTable &table)
+    : m_Table(table),
+    m_Analysed(false),
+    m_LastHash(0),
+    m_LastDims{0, 0, 0},
+    m_NHits(0),
+    m_NMisses(0)
+{
+}
+
+void Solver::findComponents(const Board &board,
+    std::vector<Component> &components)
+{
+    // Every shown number next to unknown cells gives a constraint: the
+    // number of mines among those cells, once flags are accounted for.
+    std::vector<Constraint> constraints;
+    std::vector<std::vector<size_t>> cellConstraints(board.getNCells());
+    for (Board::Pos p = 0; p < board.getNCells(); p ++)
+    {
+        Board::Cell::Value value = board.getValue(p);
+        if (board.getState(p) != Board::Cell::SHOWN || value == 0
+            || value == Board::Cell::MINE)
+        {
+            continue;
+        }
+
+        Constraint constraint;
+        constraint.second = value;
+        for (Board::Pos np : board.getNeighbors(p))
+        {
+            if (isUnknown(board.getState(np)))
+            {
+                constraint.first.push_back(np);
+            }
+            else if (board.getState(np) == Board::Cell::FLAGGED)
+            {
+                constraint.second --;
+            }
+        }
+        if (constraint.first.empty() || constraint.second < 0)
+        {
+            continue;
+        }
+
+        std::sort(constraint.first.begin(), constraint.first.end());
+        for (Board::Pos np : constraint.first)
+        {
+            cellConstraints[np].push_back(constraints.size());
+        }
+        constraints.push_back(std::move(constraint));
+    }
+
+    std::vector<size_t> parents(board.getNCells());
+    std::iota(parents.begin(), parents.end(), 0);
+    for (const Constraint &constraint : constraints)
+    {
+        for (Board::Pos p : constraint.first)
+        {
+            parents[findRoot(parents, p)] =
+                findRoot(parents, constraint.first.front());
+        }
+    }
+
+    std::unordered_map<size_t, std::vector<size_t>> groups;
+    for (size_t c = 0; c < constraints.size(); c ++)
+    {
+        groups[findRoot(parents, constraints[c].first.front())].push_back(c);
+    }
+
+    for (const auto &group : groups)
+    {
+        std::vector<Board::Pos> cells;
+        for (size_t c : group.second)
+        {
+            cells.insert(cells.end(), constraints[c].first.begin(),
+                constraints[c].first.end());
+        }
+        std::sort(cells.begin(), cells.end());
+        cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+
+        if (cells.size() <= TranspositionTable::MAX_CELLS)
+        {
+            components.push_back(makeComponent(cells, group.second,
+                constraints));
+            continue;
+        }
+
+        // Too large to enumerate: solve the local pattern around each
+        // number instead, i.e. its cells and the numbers sharing them.
+        // Certainties found this way still hold for the whole component.
+        for (size_t c : group.second)
+        {
+            std::vector<size_t> local;
+            std::vector<Board::Pos> localCells;
+            for (Board::Pos p : constraints[c].first)
+            {
+                for (size_t d : cellConstraints[p])
+                {
+                    local.push_back(d);
+                    localCells.insert(localCells.end(),
+                        constraints[d].first.begin(),
+                        constraints[d].first.end());
+                }
+            }
+            std::sort(localCells.begin(), localCells.end());
+            localCells.erase(std::unique(localCells.begin(), localCells.end()),
+                localCells.end());
+
+            if (localCells.size() > TranspositionTable::MAX_CELLS)
+            {
+                localCells = constraints[c].first;
+                local.assign(1, c);
+            }
+            components.push_back(makeComponent(localCells, local,
+                constraints));
+        }
+    }
+}
+
+Solver::Component Solver::makeComponent(const std::vector<Board::Pos> &cells,
+    const std::vector<size_t> &candidates,
+    const std::vector<Constraint> &constraints)
+{
+    Component component;
+    component.cells = cells;
+
+    for (size_t c : candidates)
+    {
+        uint32_t mask = 0;
+        bool inside = true;
+        for (Board::Pos p : constraints[c].first)
+        {
+            auto it = std::lower_bound(cells.begin(), cells.end(), p);
+            if (it == cells.end() || *it != p)
+            {
+                inside = false;
+                break;
+            }
+            mask |= 1u << (it - cells.begin());
+        }
+        if (inside)
+        {
+            component.constraints.emplace_back(mask,
+                static_cast<uint8_t>(constraints[c].second));
+        }
+    }
+
+    // Neighbouring numbers often repeat a constraint; drop the copies so
+    // that they do not cancel out in the hash.
+    std::sort(component.constraints.begin(), component.constraints.end());
+    component.constraints.erase(std::unique(component.constraints.begin(),
+        component.constraints.end()), component.constraints.end());
+    return component;
+}
+
+uint64_t Solver::getKey(const Component &component)
+{
+    // Constraints refer to cells by their rank in the component, which does
+    // not change when the whole pattern is moved, so equal local patterns get
+    // equal keys wherever they are.
+    uint64_t key = Util::mix(component.cells.size());
+    for (const auto &constraint : component.constraints)
+    {
+        key ^= Util::mix(static_cast<uint64_t>(constraint.first) << 8
+            | constraint.second);
+    }
+    return key;
+}
+
+bool Solver::solve(const Component &component,
+    TranspositionTable::Result &result)
+{
+    Enumerator enumerator(component.cells.size(), component.constraints);
+    if (!enumerator.run() || enumerator.getNSolutions() == 0)
+    {
+        return false;
+    }
+
+    uint64_t total = enumerator.getNSolutions();
+    result.nCells = static_cast<uint8_t>(component.cells.size());
+    for (size_t i = 0; i < component.cells.size(); i ++)
+    {
+        uint64_t count = enumerator.getCount(i);
+        uint8_t probability = 0;
+        if (count == total)
+        {
+            probability = 255;
+        }
+        else if (count != 0)
+        {
+            probability = static_cast<uint8_t>(std::min<uint64_t>(254,
+                std::max<uint64_t>(1, (count * 255 + total / 2) / total)));
+        }
+        result.probabilities[i] = probability;
+    }
+    return true;
+}
+
+const Solver::Analysis &Solver::analyse(const Board &board)
+{
+    // The hash keys cells by position only, so boards of another size can
+    // show the same hash for a different layout
+    Dims dims = board.getDims();
+    if (m_Analysed && board.getHash() == m_LastHash
+        && dims.nLayers == m_LastDims.nLayers
+        && dims.nRows == m_LastDims.nRows && dims.nCols == m_LastDims.nCols)
+    {
+        return m_Analysis;
+    }
+    m_Analysed = true;
+    m_LastHash = board.getHash();
+    m_LastDims = dims;
+
+    m_Analysis.safe.clear();
+    m_Analysis.mines.clear();
+    m_Analysis.probabilities.clear();
+
+    std::vector<Component> components;
+    findComponents(board, components);
+
+    // A cell can be part of several local patterns; any certainty wins,
+    // otherwise the first estimate is kept.
+    std::unordered_map<Board::Pos, uint8_t> probabilities;
+    std::vector<Board::Pos> order;
+
+    for (const Component &component : components)
+    {
+        if (component.constraints.empty())
+        {
+            continue;
+        }
+
+        uint64_t key = getKey(component);
+        TranspositionTable::Result result;
+        if (m_Table.find(key, result)
+            && result.nCells == component.cells.size())
+        {
+            m_NHits ++;
+        }
+        else
+        {
+            m_NMisses ++;
+            if (!solve(component, result))
+            {
+                continue;
+            }
+            m_Table.store(key, result);
+        }
+
+        for (size_t i = 0; i < component.cells.size(); i ++)
+        {
+            uint8_t probability = result.probabilities[i];
+            auto it = probabilities.emplace(component.cells[i], probability);
+            if (it.second)
+            {
+                order.push_back(component.cells[i]);
+            }
+            else if (probability == 0 || probability == 255)
+            {
+                it.first->second = probability;
+            }
+        }
+    }
+
+    for (Board::Pos p : order)
+    {
+        uint8_t probability = probabilities[p];
+        if (probability == 0)
+        {
+            m_Analysis.safe.push_back(p);
+        }
+        else if (probability == 255)
+        {
+            m_Analysis.mines.push_back(p);
+        }
+        m_Analysis.probabilities.emplace_back(p, probability / 255.0f);
+    }
+    return m_Analysis;
+}
@@ -0,0 +1,66 @@
+#ifndef CANH_SOLVER_H
+#define CANH_SOLVER_H
+
+#include "board.h"
+#include "transposition_table.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Deduces safe cells, mines and mine probabilities on the frontier of a board.
+// The frontier is split into independent components (unknown cells linked by
+// the numbers around them); each component, or the local pattern around each
+// number when the component is too large, is solved by enumeration and the
+// result is cached in a TranspositionTable under a Zobrist hash of its
+// constraints. The hash does not depend on where the component sits, so the
+// same local pattern is solved once and reused across positions, games and
+// every Solver sharing the table.
+class Solver
+{
+public:
+    struct Analysis
+    {
+        std::vector<Board::Pos> safe;
+        std::vector<Board::Pos> mines;
+        std::vector<std::pair<Board::Pos, float>> probabilities;
+    };
+
+    explicit Solver(TranspositionTable &table);
+
+    // Cheap when the board hash and size did not change since the last call
+    const Analysis &analyse(const Board &board);
+
+    size_t getNHits() const { return m_NHits; }
+    size_t getNMisses() const { return m_NMisses; }
+
+private:
+    // Unknown cells and the number of mines among them
+    typedef std::pair<std::vector<Board::Pos>, int> Constraint;
+
+    struct Component
+    {
+        std::vector<Board::Pos> cells;
+        std::vector<std::pair<uint32_t, uint8_t>> constraints;
+    };
+
+    TranspositionTable &m_Table;
+    bool m_Analysed;
+    uint64_t m_LastHash;
+    Dims m_LastDims;
+    Analysis m_Analysis;
+    size_t m_NHits;
+    size_t m_NMisses;
+
+    static void findComponents(const Board &board,
+        std::vector<Component> &components);
+    static Component makeComponent(const std::vector<Board::Pos> &cells,
+        const std::vector<size_t> &candidates,
+        const std::vector<Constraint> &constraints);
+    static uint64_t getKey(const Component &component);
+    static bool solve(const Component &component,
+        TranspositionTable::Result &result);
+};
+
+#endif
@@ -0,0 +1,82 @@
+#include "sprite_atlas.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#   include <tmmintrin.h>
+#   define CANH_SPRITE_SSSE3 1
+#else
+#   define CANH_SPRITE_SSSE3 0
+#endif
+
+constexpr std::array<SpriteAtlas::Rect, SpriteAtlas::SPRITE_TOTAL>
+    SpriteAtlas::RECTS;
+constexpr SpriteAtlas::CellLut SpriteAtlas::CELL_LUT;
+
+static_assert(SpriteAtlas::getCellSprite(Board::LOST, Board::Cell::FLAGGED, 3)
+    == SpriteAtlas::CELL_MINE_WRONG, "Wrong flags are shown on loss");
+
+namespace
+{
+#if CANH_SPRITE_SSSE3
+    // Sprites from one table of 16 for the cells in state s, zero elsewhere
+    __attribute__((target("ssse3")))
+    inline __m128i lookup(__m128i table, char s, __m128i state, __m128i value)
+    {
+        return _mm_and_si128(_mm_cmpeq_epi8(state, _mm_set1_epi8(s)),
+            _mm_shuffle_epi8(table, value));
+    }
+
+    // The 64 sprites of a game state are four tables of 16, one per cell
+    // state and indexed by value, which is what pshufb looks up. Each cell
+    // keeps the lookup from the table of its own state. Returns how many
+    // cells were translated, a multiple of 16.
+    __attribute__((target("ssse3")))
+    size_t translateSsse3(const uint8_t *lut, const uint8_t *cells, size_t n,
+        uint8_t *sprites)
+    {
+        __m128i tables[4];
+        for (int s = 0; s < 4; s ++)
+        {
+            tables[s] = _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(lut + 16 * s));
+        }
+        const __m128i valueMask = _mm_set1_epi8(0x0F);
+        const __m128i stateMask = _mm_set1_epi8(0x03);
+
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i packed = _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(cells + i));
+            __m128i value = _mm_and_si128(packed, valueMask);
+            __m128i state = _mm_and_si128(_mm_srli_epi16(packed, 4),
+                stateMask);
+            __m128i result = _mm_or_si128(
+                _mm_or_si128(lookup(tables[0], 0, state, value),
+                    lookup(tables[1], 1, state, value)),
+                _mm_or_si128(lookup(tables[2], 2, state, value),
+                    lookup(tables[3], 3, state, value)));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(sprites + i),
+                result);
+        }
+        return i;
+    }
+#endif
+}
+
+void SpriteAtlas::translateRow(Board::State gameState, const uint8_t *cells,
+    size_t n, uint8_t *sprites)
+{
+    const uint8_t *lut = CELL_LUT.sprites + (gameState << 6);
+    size_t i = 0;
+#if CANH_SPRITE_SSSE3
+    static const bool hasSsse3 = __builtin_cpu_supports("ssse3");
+    if (hasSsse3)
+    {
+        i = translateSsse3(lut, cells, n, sprites);
+    }
+#endif
+    for (; i < n; i ++)
+    {
+        sprites[i] = lut[cells[i] & 0x3F];
+    }
+}
@@ -0,0 +1,155 @@
+#ifndef CANH_SPRITE_ATLAS_H
+#define CANH_SPRITE_ATLAS_H
+
+#include "board.h"
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+// Layout of sprite.png and the mapping from cells to sprites, all computed
+// at compile time and free of any SDL dependency.
+class SpriteAtlas
+{
+public:
+    typedef int32_t Size;
+
+    enum Sprite : uint8_t
+    {
+        CELL_ZERO = 0,
+        CELL_ONE,
+        CELL_TWO,
+        CELL_THREE,
+        CELL_FOUR,
+        CELL_FIVE,
+        CELL_SIX,
+        CELL_SEVEN,
+        CELL_EIGHT,
+        CELL_MINE,
+        CELL_MINE_WRONG,
+        CELL_MINE_CURRENT,
+        CELL_QUESTION_MARK,
+        CELL_FLAG,
+        CELL_UNOPENED,
+
+        COUNT_ZERO,
+        COUNT_ONE,
+        COUNT_TWO,
+        COUNT_THREE,
+        COUNT_FOUR,
+        COUNT_FIVE,
+        COUNT_SIX,
+        COUNT_SEVEN,
+        COUNT_EIGHT,
+        COUNT_NINE,
+
+        EMOJI_SELECTING,
+        EMOJI_PLAYING,
+        EMOJI_CELL_SELECTING,
+        EMOJI_LOST,
+        EMOJI_WON,
+
+        SPRITE_TOTAL
+    };
+
+    // Same layout as SDL_Rect
+    struct Rect
+    {
+        Size x, y, w, h;
+    };
+
+    // sprite.png decoded to RGBA rows at build time, see tools/embed_png.py
+    static const Size IMAGE_W;
+    static const Size IMAGE_H;
+    static const uint8_t PIXELS[];
+
+    static constexpr Size CELL_W = 16;
+    static constexpr Size CELL_H = 16;
+    static constexpr Size COUNT_W = 13;
+    static constexpr Size COUNT_H = 23;
+    static constexpr Size EMOJI_W = 26;
+    static constexpr Size EMOJI_H = 26;
+
+    static constexpr std::array<Rect, SPRITE_TOTAL> RECTS = {{
+        {0*CELL_W, 0, CELL_W, CELL_H},
+        {1*CELL_W, 0, CELL_W, CELL_H},
+        {2*CELL_W, 0, CELL_W, CELL_H},
+        {3*CELL_W, 0, CELL_W, CELL_H},
+        {4*CELL_W, 0, CELL_W, CELL_H},
+        {5*CELL_W, 0, CELL_W, CELL_H},
+        {6*CELL_W, 0, CELL_W, CELL_H},
+        {7*CELL_W, 0, CELL_W, CELL_H},
+        {8*CELL_W, 0, CELL_W, CELL_H},
+
+        {0*CELL_W, CELL_H, CELL_W, CELL_H},
+        {1*CELL_W, CELL_H, CELL_W, CELL_H},
+        {2*CELL_W, CELL_H, CELL_W, CELL_H},
+        {3*CELL_W, CELL_H, CELL_W, CELL_H},
+        {4*CELL_W, CELL_H, CELL_W, CELL_H},
+        {5*CELL_W, CELL_H, CELL_W, CELL_H},
+
+        {0*COUNT_W, 2*CELL_H, COUNT_W, COUNT_H},
+        {1*COUNT_W, 2*CELL_H, COUNT_W, COUNT_H},
+        {2*COUNT_W, 2*CELL_H, COUNT_W, COUNT_H},
+        {3*COUNT_W, 2*CELL_H, COUNT_W, COUNT_H},
+        {4*COUNT_W, 2*CELL_H, COUNT_W, COUNT_H},
+        {5*COUNT_W, 2*CELL_H, COUNT_W, COUNT_H},
+        {6*COUNT_W, 2*CELL_H, COUNT_W, COUNT_H},
+        {7*COUNT_W, 2*CELL_H, COUNT_W, COUNT_H},
+        {8*COUNT_W, 2*CELL_H, COUNT_W, COUNT_H},
+        {9*COUNT_W, 2*CELL_H, COUNT_W, COUNT_H},
+
+        {0*EMOJI_W, 2*CELL_H + COUNT_H, EMOJI_W, EMOJI_H},
+        {1*EMOJI_W, 2*CELL_H + COUNT_H, EMOJI_W, EMOJI_H},
+        {2*EMOJI_W, 2*CELL_H + COUNT_H, EMOJI_W, EMOJI_H},
+        {3*EMOJI_W, 2*CELL_H + COUNT_H, EMOJI_W, EMOJI_H},
+        {4*EMOJI_W, 2*CELL_H + COUNT_H, EMOJI_W, EMOJI_H}
+    }};
+
+    static constexpr Sprite getCellSprite(Board::State gameState,
+        Board::Cell::State state, Board::Cell::Value value)
+    {
+        return value > Board::Cell::MINE ? CELL_UNOPENED
+            : gameState == Board::WON
+                ? (value == Board::Cell::MINE ? CELL_FLAG
+                    : static_cast<Sprite>(CELL_ZERO + value))
+            : gameState == Board::LOST && value == Board::Cell::MINE
+                ? (state == Board::Cell::SHOWN ? CELL_MINE_CURRENT : CELL_MINE)
+            : gameState == Board::LOST && state == Board::Cell::FLAGGED
+                ? CELL_MINE_WRONG
+            : gameState == Board::LOST && state == Board::Cell::UNKNOWN
+                ? static_cast<Sprite>(CELL_ZERO + value)
+            : state == Board::Cell::HIDDEN ? CELL_UNOPENED
+            : state == Board::Cell::FLAGGED ? CELL_FLAG
+            : state == Board::Cell::UNKNOWN ? CELL_QUESTION_MARK
+            : value == Board::Cell::MINE ? CELL_MINE_CURRENT
+            : static_cast<Sprite>(CELL_ZERO + value);
+    }
+
+    // Converts cells packed as in GameLogic::Snapshot (state << 4 | value)
+    // into sprites. Table lookups only, so a whole row is translated without
+    // branching, sixteen cells at a time on CPUs with SSSE3.
+    static void translateRow(Board::State gameState, const uint8_t *cells,
+        size_t n, uint8_t *sprites);
+
+private:
+    // Indexed by game state, cell state and value: 2 + 2 + 4 bits
+    struct CellLut
+    {
+        uint8_t sprites[256];
+
+        constexpr CellLut() : sprites()
+        {
+            for (unsigned i = 0; i < 256; i ++)
+            {
+                sprites[i] = getCellSprite(static_cast<Board::State>(i >> 6),
+                    static_cast<Board::Cell::State>(i >> 4 & 0x3), i & 0xF);
+            }
+        }
+    };
+
+    // Built at compile time in sprite_atlas.cpp
+    static const CellLut CELL_LUT;
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef CANH_SPSC_QUEUE_H
+#define CANH_SPSC_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Bounded wait-free queue for exactly one producer and one consumer thread.
+// N must be a power of two.
+template <typename T, size_t N>
+class SpscQueue
+{
+public:
+    SpscQueue() : m_Head(0), m_Tail(0) {}
+
+    // Producer side. Returns false instead of waiting when the queue is full.
+    bool push(const T &item)
+    {
+        size_t tail = m_Tail.load(std::memory_order_relaxed);
+        if (tail - m_Head.load(std::memory_order_acquire) == N)
+        {
+            return false;
+        }
+        m_Items[tail & (N - 1)] = item;
+        m_Tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when the queue is empty.
+    bool pop(T &item)
+    {
+        size_t head = m_Head.load(std::memory_order_relaxed);
+        if (head == m_Tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        item = m_Items[head & (N - 1)];
+        m_Head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool empty() const
+    {
+        return m_Head.load(std::memory_order_relaxed)
+            == m_Tail.load(std::memory_order_acquire);
+    }
+
+private:
+    static_assert((N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+    std::array<T, N> m_Items;
+    alignas(64) std::atomic<size_t> m_Head;
+    alignas(64) std::atomic<size_t> m_Tail;
+};
+
+#endif
@@ -0,0 +1,356 @@
+#include "game_stats.h"
+#include "util.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Reports win rate, solve time percentiles and 3BV/s per difficulty from a
+// statistics file, or fills one with synthetic games for benchmarking.
+
+namespace
+{
+    // Times are bucketed by second; longer games share the last bucket
+    const uint32_t MAX_SEC = 4095;
+
+    struct Filter
+    {
+        int64_t nRows;
+        int64_t nCols;
+        int64_t nMines;
+
+        bool matches(const GameStats::BlockHeader &h) const
+        {
+            return within(nRows, h, GameStats::N_ROWS)
+                && within(nCols, h, GameStats::N_COLS)
+                && within(nMines, h, GameStats::N_MINES);
+        }
+
+        bool matches(uint16_t r, uint16_t c, uint16_t m) const
+        {
+            return (nRows < 0 || nRows == r) && (nCols < 0 || nCols == c)
+                && (nMines < 0 || nMines == m);
+        }
+
+        static bool within(int64_t x, const GameStats::BlockHeader &h,
+            GameStats::Column column)
+        {
+            return x < 0 || (h.min[column] <= static_cast<uint64_t>(x)
+                && static_cast<uint64_t>(x) <= h.max[column]);
+        }
+    };
+
+    struct Group
+    {
+        uint64_t nGames;
+        uint64_t nWon;
+        uint64_t bv3Won;
+        uint64_t secWon;
+        std::vector<uint64_t> histogram;
+
+        Group() : nGames(0), nWon(0), bv3Won(0), secWon(0),
+            histogram(MAX_SEC + 1, 0)
+        {
+        }
+
+        void merge(const Group &other)
+        {
+            nGames += other.nGames;
+            nWon += other.nWon;
+            bv3Won += other.bv3Won;
+            secWon += other.secWon;
+            for (size_t i = 0; i <= MAX_SEC; i ++)
+            {
+                histogram[i] += other.histogram[i];
+            }
+        }
+
+        uint32_t getPercentile(double q) const
+        {
+            uint64_t rank = static_cast<uint64_t>(q * (nWon - 1));
+            uint64_t seen = 0;
+            for (uint32_t s = 0; s <= MAX_SEC; s ++)
+            {
+                seen += histogram[s];
+                if (seen > rank)
+                {
+                    return s;
+                }
+            }
+            return MAX_SEC;
+        }
+    };
+
+    typedef uint64_t Key;
+    typedef std::unordered_map<Key, Group> Groups;
+
+    Key makeKey(uint16_t r, uint16_t c, uint16_t m)
+    {
+        return static_cast<Key>(r) << 32 | static_cast<Key>(c) << 16 | m;
+    }
+
+    // Columns are plain arrays, so these loops carry no branches and the
+    // compiler turns the sums into SIMD code.
+    void scanUniform(const GameStatsReader::Block &block, Group &group)
+    {
+        uint32_t n = block.header->nRows;
+        uint64_t nWon = 0, bv3 = 0, sec = 0;
+        for (uint32_t i = 0; i < n; i ++)
+        {
+            uint32_t won = block.won[i];
+            nWon += won;
+            bv3 += block.bv3[i] * won;
+            sec += block.elapsedSec[i] * won;
+        }
+        for (uint32_t i = 0; i < n; i ++)
+        {
+            group.histogram[std::min(block.elapsedSec[i], MAX_SEC)] +=
+                block.won[i];
+        }
+        group.nGames += n;
+        group.nWon += nWon;
+        group.bv3Won += bv3;
+        group.secWon += sec;
+    }
+
+    void scanMixed(const GameStatsReader::Block &block, const Filter &filter,
+        Groups &groups)
+    {
+        Key lastKey = ~static_cast<Key>(0);
+        Group *group = nullptr;
+        for (uint32_t i = 0; i < block.header->nRows; i ++)
+        {
+            uint16_t r = block.nRows[i], c = block.nCols[i];
+            uint16_t m = block.nMines[i];
+            if (!filter.matches(r, c, m))
+            {
+                continue;
+            }
+
+            Key key = makeKey(r, c, m);
+            if (key != lastKey)
+            {
+                lastKey = key;
+                group = &groups[key];
+            }
+            uint32_t won = block.won[i];
+            group->nGames ++;
+            group->nWon += won;
+            group->bv3Won += block.bv3[i] * won;
+            group->secWon += block.elapsedSec[i] * won;
+            group->histogram[std::min(block.elapsedSec[i], MAX_SEC)] += won;
+        }
+    }
+
+    int query(const std::string &path, const Filter &filter,
+        unsigned nThreads)
+    {
+        auto start = std::chrono::steady_clock::now();
+        GameStatsReader reader(path);
+        const std::vector<GameStatsReader::Block> &blocks = reader.getBlocks();
+
+        std::atomic<size_t> nextBlock(0);
+        std::atomic<size_t> nSkipped(0);
+        std::vector<Groups> threadGroups(nThreads);
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < nThreads; t ++)
+        {
+            threads.emplace_back([&, t] {
+                Groups &groups = threadGroups[t];
+                size_t b = 0;
+                while ((b = nextBlock.fetch_add(1)) < blocks.size())
+                {
+                    const GameStatsReader::Block &block = blocks[b];
+                    const GameStats::BlockHeader &h = *block.header;
+                    if (!filter.matches(h))
+                    {
+                        nSkipped ++;
+                        continue;
+                    }
+
+                    // Games are usually recorded in runs of one difficulty,
+                    // which the block bounds reveal without a row scan
+                    if (h.min[GameStats::N_ROWS] == h.max[GameStats::N_ROWS]
+                        && h.min[GameStats::N_COLS] == h.max[GameStats::N_COLS]
+                        && h.min[GameStats::N_MINES]
+                            == h.max[GameStats::N_MINES])
+                    {
+                        scanUniform(block, groups[makeKey(block.nRows[0],
+                            block.nCols[0], block.nMines[0])]);
+                    }
+                    else
+                    {
+                        scanMixed(block, filter, groups);
+                    }
+                }
+            });
+        }
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+
+        std::map<Key, Group> total;
+        for (const Groups &groups : threadGroups)
+        {
+            for (const auto &kv : groups)
+            {
+                total[kv.first].merge(kv.second);
+            }
+        }
+
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+        std::printf("%-16s %12s %7s %6s %6s %6s %7s\n", "difficulty", "games",
+            "win%", "p50", "p90", "p99", "3BV/s");
+        for (const auto &kv : total)
+        {
+            const Group &g = kv.second;
+            std::string difficulty = std::to_string(kv.first >> 32) + "x"
+                + std::to_string(kv.first >> 16 & 0xFFFF) + "/"
+                + std::to_string(kv.first & 0xFFFF);
+            double winRate = g.nGames > 0 ? 100.0 * g.nWon / g.nGames : 0.0;
+            double bv3PerSec = g.secWon > 0
+                ? static_cast<double>(g.bv3Won) / g.secWon : 0.0;
+            if (g.nWon > 0)
+            {
+                std::printf("%-16s %12llu %6.2f%% %6u %6u %6u %7.3f\n",
+                    difficulty.c_str(),
+                    static_cast<unsigned long long>(g.nGames), winRate,
+                    g.getPercentile(0.5), g.getPercentile(0.9),
+                    g.getPercentile(0.99), bv3PerSec);
+            }
+            else
+            {
+                std::printf("%-16s %12llu %6.2f%% %6s %6s %6s %7s\n",
+                    difficulty.c_str(),
+                    static_cast<unsigned long long>(g.nGames), winRate,
+                    "-", "-", "-", "-");
+            }
+        }
+        std::printf("%llu records, %zu of %zu blocks skipped, %lld ms\n",
+            static_cast<unsigned long long>(reader.getNRecords()),
+            nSkipped.load(), blocks.size(), static_cast<long long>(ms));
+        return EXIT_SUCCESS;
+    }
+
+    int generate(const std::string &path, uint64_t nRecords)
+    {
+        struct Difficulty
+        {
+            uint16_t nRows, nCols, nMines;
+            double winRate;
+            double bv3, secPerBv3;
+        };
+        const Difficulty DIFFICULTIES[] = {
+            {9, 9, 10, 0.9, 18, 0.5},
+            {16, 16, 40, 0.75, 60, 0.7},
+            {16, 30, 99, 0.4, 130, 0.9}
+        };
+
+        std::mt19937_64 rng(Util::getRNG()());
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        GameStatsWriter writer(path);
+
+        // Games come in sessions of one difficulty, like real players play
+        uint64_t i = 0;
+        while (i < nRecords)
+        {
+            const Difficulty &d = DIFFICULTIES[rng() % 3];
+            uint64_t session = std::min<uint64_t>(nRecords - i,
+                1 + rng() % 100000);
+            for (uint64_t j = 0; j < session; j ++, i ++)
+            {
+                GameRecord record;
+                record.seed = rng();
+                record.nRows = d.nRows;
+                record.nCols = d.nCols;
+                record.nMines = d.nMines;
+                record.won = uniform(rng) < d.winRate ? 1 : 0;
+                record.bv3 = static_cast<uint32_t>(d.bv3
+                    * (0.5 + uniform(rng)));
+                double progress = record.won ? 1.0 : uniform(rng);
+                record.elapsedSec = static_cast<uint32_t>(record.bv3
+                    * progress * d.secPerBv3 * (0.5 + 2 * uniform(rng)));
+                record.nClicks = static_cast<uint32_t>(record.bv3 * progress
+                    * (1.0 + uniform(rng)));
+                writer.append(record);
+            }
+        }
+        return EXIT_SUCCESS;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::string path;
+    Filter filter = {-1, -1, -1};
+    unsigned nThreads = std::max(1u, std::thread::hardware_concurrency());
+    uint64_t nGenerate = 0;
+    bool valid = argc >= 2;
+
+    for (int i = 2; valid && i < argc; i += 2)
+    {
+        std::string arg = argv[i];
+        if (i + 1 == argc)
+        {
+            valid = false;
+        }
+        else if (arg == "--rows")
+        {
+            filter.nRows = std::atoi(argv[i + 1]);
+        }
+        else if (arg == "--cols")
+        {
+            filter.nCols = std::atoi(argv[i + 1]);
+        }
+        else if (arg == "--mines")
+        {
+            filter.nMines = std::atoi(argv[i + 1]);
+        }
+        else if (arg == "--threads")
+        {
+            nThreads = std::max(1, std::atoi(argv[i + 1]));
+        }
+        else if (arg == "--generate")
+        {
+            nGenerate = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+        else
+        {
+            valid = false;
+        }
+    }
+
+    if (!valid)
+    {
+        std::cerr << "Usage: " << argv[0] << " FILE"
+                  << " [--rows N] [--cols N] [--mines N] [--threads N]"
+                  << std::endl
+                  << "       " << argv[0] << " FILE --generate N"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        return nGenerate > 0 ? generate(argv[1], nGenerate)
+                             : query(argv[1], filter, nThreads);
+    }
+    catch (GameStats::Exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,465 @@
+#include "terminal.h"
+#include "board.h"
+#include "renderer.h"
+#include "sprite_atlas.h"
+#include "topology.h"
+
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <string>
+
+namespace
+{
+    // SGR parameters of each Terminal::Style
+    const char *const STYLE_SGR[] = {
+        "0",        // PLAIN
+        "0;90",     // HIDDEN
+        "0;1;31",   // FLAG
+        "0;1;33",   // QUESTION_MARK
+        "0;1",      // MINE
+        "0;1;31",   // MINE_WRONG
+        "0;1;97;41", // MINE_CURRENT
+        "0;94",     // 1
+        "0;32",     // 2
+        "0;91",     // 3
+        "0;34",     // 4
+        "0;31",     // 5
+        "0;36",     // 6
+        "0;1",      // 7
+        "0;90"      // 8
+    };
+
+    // How long to wait for the rest of an escape sequence
+    const int ESCAPE_TIMEOUT_MS = 50;
+
+    const char *getEmojiText(SpriteAtlas::Sprite emoji)
+    {
+        switch (emoji)
+        {
+            case SpriteAtlas::EMOJI_SELECTING:
+                return ":D";
+            case SpriteAtlas::EMOJI_CELL_SELECTING:
+                return ":o";
+            case SpriteAtlas::EMOJI_LOST:
+                return "X(";
+            case SpriteAtlas::EMOJI_WON:
+                return "B)";
+            default:
+                return ":)";
+        }
+    }
+}
+
+const int Terminal::CELL_W;
+const int Terminal::BOARD_Y;
+
+Terminal::Terminal()
+    : m_NRows(0),
+    m_NCols(0),
+    m_Dims({1, 0, 0}),
+    m_CursorLayer(0),
+    m_CursorRow(0),
+    m_CursorCol(0),
+    m_ViewX(0),
+    m_ViewY(0)
+{
+    if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO))
+    {
+        throw Exception("Standard input and output must be a terminal!");
+    }
+    if (tcgetattr(STDIN_FILENO, &m_SavedTermios) != 0)
+    {
+        throw Exception("Can not read terminal attributes!");
+    }
+
+    struct termios raw = m_SavedTermios;
+    raw.c_iflag &= ~(BRKINT | ICRNL | INPCK | ISTRIP | IXON);
+    raw.c_oflag &= ~OPOST;
+    raw.c_cflag |= CS8;
+    raw.c_lflag &= ~(ECHO | ICANON | IEXTEN | ISIG);
+    raw.c_cc[VMIN] = 0;
+    raw.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) != 0)
+    {
+        throw Exception("Can not switch the terminal to raw mode!");
+    }
+
+    // Alternate screen, hidden cursor
+    write("\x1b[?1049h\x1b[?25l");
+}
+
+Terminal::~Terminal()
+{
+    write("\x1b[0m\x1b[?25h\x1b[?1049l");
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &m_SavedTermios);
+}
+
+bool Terminal::resize()
+{
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) != 0
+        || (ws.ws_row == m_NRows && ws.ws_col == m_NCols))
+    {
+        return false;
+    }
+
+    // After a clear the terminal holds blanks, so only the non-blank part
+    // of the next frame is sent
+    m_NRows = ws.ws_row;
+    m_NCols = ws.ws_col;
+    m_Screen.assign(m_NRows * m_NCols, {' ', PLAIN});
+    m_Shadow = m_Screen;
+    m_Out += "\x1b[0m\x1b[2J";
+    return true;
+}
+
+void Terminal::drawBoard(const Dims &dims, const uint8_t *sprites)
+{
+    resize();
+    std::fill(m_Screen.begin(), m_Screen.end(), Char{' ', PLAIN});
+
+    if (dims.nLayers != m_Dims.nLayers || dims.nRows != m_Dims.nRows
+        || dims.nCols != m_Dims.nCols)
+    {
+        m_Dims = dims;
+        m_CursorLayer = std::min(m_CursorLayer, dims.nLayers - 1);
+        m_CursorRow = std::min(m_CursorRow, dims.nRows - 1);
+        m_CursorCol = std::min(m_CursorCol, dims.nCols - 1);
+    }
+
+    // Boards larger than the window scroll to keep the cursor in view, with
+    // the banner above and the key help below
+    int viewW = std::max(CELL_W, m_NCols);
+    int viewH = std::max(1, m_NRows - BOARD_Y - 2);
+    int cursorX = 0, cursorY = 0;
+    Board::Topology::getCellOrigin(dims, m_CursorLayer, m_CursorRow,
+        m_CursorCol, CELL_W, 1, cursorX, cursorY);
+    m_ViewX = std::max(std::min(m_ViewX, cursorX), cursorX + CELL_W - viewW);
+    m_ViewY = std::max(std::min(m_ViewY, cursorY), cursorY + 1 - viewH);
+
+    Board::Pos cursor = getCursorPos();
+    Board::Pos p = 0;
+    for (int l = 0; l < dims.nLayers; l ++)
+    {
+        for (int r = 0; r < dims.nRows; r ++)
+        {
+            for (int c = 0; c < dims.nCols; c ++, p ++)
+            {
+                uint8_t sprite = sprites[p];
+                char text[] = "  ";
+                uint8_t style = PLAIN;
+                if (sprite == SpriteAtlas::CELL_ZERO)
+                {
+                    text[0] = ' ';
+                }
+                else if (sprite <= SpriteAtlas::CELL_EIGHT)
+                {
+                    text[0] = static_cast<char>('0' + sprite);
+                    style = NUMBER + sprite - SpriteAtlas::CELL_ONE;
+                }
+                else
+                {
+                    switch (sprite)
+                    {
+                        case SpriteAtlas::CELL_MINE:
+                            text[0] = '*';
+                            style = MINE;
+                            break;
+                        case SpriteAtlas::CELL_MINE_WRONG:
+                            text[0] = 'X';
+                            style = MINE_WRONG;
+                            break;
+                        case SpriteAtlas::CELL_MINE_CURRENT:
+                            text[0] = '*';
+                            style = MINE_CURRENT;
+                            break;
+                        case SpriteAtlas::CELL_QUESTION_MARK:
+                            text[0] = '?';
+                            style = QUESTION_MARK;
+                            break;
+                        case SpriteAtlas::CELL_FLAG:
+                            text[0] = 'F';
+                            style = FLAG;
+                            break;
+                        default:
+                            text[0] = '.';
+                            style = HIDDEN;
+                            break;
+                    }
+                }
+                if (p == cursor)
+                {
+                    style |= CURSOR;
+                }
+
+                int x = 0, y = 0;
+                Board::Topology::getCellOrigin(dims, l, r, c, CELL_W, 1, x, y);
+                if (m_ViewY <= y && y < m_ViewY + viewH)
+                {
+                    put(BOARD_Y + y - m_ViewY, x - m_ViewX, text, style);
+                }
+            }
+        }
+    }
+
+    put(BOARD_Y + std::min(Board::Topology::getLayoutRows(dims), viewH) + 1, 0,
+        "arrows move, space open, f flag, u undo, r new game, q quit",
+        HIDDEN);
+}
+
+void Terminal::drawBanner(Board::Size nMinesRemaining, Timer::Sec sec,
+    SpriteAtlas::Sprite emoji)
+{
+    int width = std::max(11, std::min(m_NCols,
+        Board::Topology::getLayoutCols(m_Dims) * CELL_W - 1));
+    char count[8];
+
+    std::snprintf(count, sizeof(count), "%03u",
+        std::min(999u, static_cast<unsigned>(nMinesRemaining)));
+    put(0, 0, count, PLAIN);
+    put(0, width / 2 - 1, getEmojiText(emoji), PLAIN);
+    std::snprintf(count, sizeof(count), "%03u",
+        std::min(999u, static_cast<unsigned>(sec)));
+    put(0, width - 3, count, PLAIN);
+}
+
+void Terminal::present()
+{
+    // Move only when the next change is not where the last one ended, and
+    // switch style only when it differs
+    int lastY = -1, lastX = -1;
+    int lastStyle = -1;
+    for (int y = 0; y < m_NRows; y ++)
+    {
+        for (int x = 0; x < m_NCols; x ++)
+        {
+            size_t i = static_cast<size_t>(y) * m_NCols + x;
+            const Char &ch = m_Screen[i];
+            if (ch == m_Shadow[i])
+            {
+                continue;
+            }
+            if (y != lastY || x != lastX)
+            {
+                m_Out += "\x1b[" + std::to_string(y + 1) + ";"
+                    + std::to_string(x + 1) + "H";
+            }
+            if (ch.style != lastStyle)
+            {
+                appendStyle(ch.style);
+                lastStyle = ch.style;
+            }
+            m_Out += ch.ch;
+            m_Shadow[i] = ch;
+            lastY = y;
+            lastX = x + 1;
+        }
+    }
+
+    if (!m_Out.empty())
+    {
+        write(m_Out);
+        m_Out.clear();
+    }
+}
+
+bool Terminal::pollInput(Input &input, int timeoutMs)
+{
+    if (m_In.empty() && !readInput(timeoutMs))
+    {
+        // A resized window needs a new frame even without a key
+        if (!resize())
+        {
+            return false;
+        }
+        input = {Input::NONE, Board::POS_UNDEFINED};
+        return true;
+    }
+    input = mapKey();
+    return true;
+}
+
+void Terminal::put(int y, int x, const char *text, uint8_t style)
+{
+    if (y < 0 || y >= m_NRows)
+    {
+        return;
+    }
+    for (; *text != '\0' && x < m_NCols; text ++, x ++)
+    {
+        if (x >= 0)
+        {
+            m_Screen[static_cast<size_t>(y) * m_NCols + x] = {*text, style};
+        }
+    }
+}
+
+void Terminal::appendStyle(uint8_t style)
+{
+    m_Out += "\x1b[";
+    m_Out += STYLE_SGR[style & ~CURSOR];
+    if (style & CURSOR)
+    {
+        m_Out += ";7";
+    }
+    m_Out += "m";
+}
+
+void Terminal::write(const std::string &data) const
+{
+    size_t done = 0;
+    while (done < data.size())
+    {
+        ssize_t n = ::write(STDOUT_FILENO, data.data() + done,
+            data.size() - done);
+        if (n < 0 && errno != EINTR)
+        {
+            return;
+        }
+        done += n > 0 ? n : 0;
+    }
+}
+
+bool Terminal::readInput(int timeoutMs)
+{
+    struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+    if (poll(&pfd, 1, timeoutMs) <= 0)
+    {
+        return false;
+    }
+
+    char buf[256];
+    ssize_t n = read(STDIN_FILENO, buf, sizeof(buf));
+    if (n <= 0)
+    {
+        return false;
+    }
+    m_In.append(buf, n);
+    return true;
+}
+
+Renderer::Input Terminal::mapKey()
+{
+    Input input = {Input::NONE, Board::POS_UNDEFINED};
+    char key = m_In[0];
+    size_t n = 1;
+
+    if (key == '\x1b')
+    {
+        // Arrow keys arrive as ESC [ A or ESC O A, possibly split across
+        // reads on a slow link
+        if (m_In.size() < 3)
+        {
+            readInput(ESCAPE_TIMEOUT_MS);
+        }
+        if (m_In.size() >= 3 && (m_In[1] == '[' || m_In[1] == 'O'))
+        {
+            // Skip parameters up to the final byte
+            size_t f = 2;
+            while (f < m_In.size() && !('@' <= m_In[f] && m_In[f] <= '~'))
+            {
+                f ++;
+            }
+            if (f < m_In.size())
+            {
+                n = f + 1;
+                key = m_In[f];
+                switch (key)
+                {
+                    case 'A':
+                        key = 'k';
+                        break;
+                    case 'B':
+                        key = 'j';
+                        break;
+                    case 'C':
+                        key = 'l';
+                        break;
+                    case 'D':
+                        key = 'h';
+                        break;
+                    default:
+                        key = '\0';
+                        break;
+                }
+            }
+        }
+    }
+    m_In.erase(0, n);
+
+    switch (key)
+    {
+        case 'k':
+            moveCursor(-1, 0);
+            break;
+        case 'j':
+            moveCursor(1, 0);
+            break;
+        case 'h':
+            moveCursor(0, -1);
+            break;
+        case 'l':
+            moveCursor(0, 1);
+            break;
+        case ' ':
+        case '\r':
+        case '\n':
+            input = {Input::OPEN, getCursorPos()};
+            break;
+        case 'f':
+            input = {Input::NEXT_STATE, getCursorPos()};
+            break;
+        case 'u':
+            input.type = Input::UNDO;
+            break;
+        case '\x12':    // ctrl-r
+            input.type = Input::REDO;
+            break;
+        case 'r':
+            input.type = Input::RESET;
+            break;
+        case 'q':
+        case '\x03':    // ctrl-c
+            input.type = Input::QUIT;
+            break;
+        default:
+            break;
+    }
+    return input;
+}
+
+void Terminal::moveCursor(int dRow, int dCol)
+{
+    m_CursorRow = std::max(0, std::min(m_Dims.nRows - 1, m_CursorRow + dRow));
+
+    // Layers are side by side, so moving past an edge enters the next one
+    int c = m_CursorCol + dCol;
+    if (c < 0 && m_CursorLayer > 0)
+    {
+        m_CursorLayer --;
+        c = m_Dims.nCols - 1;
+    }
+    else if (c >= m_Dims.nCols && m_CursorLayer + 1 < m_Dims.nLayers)
+    {
+        m_CursorLayer ++;
+        c = 0;
+    }
+    m_CursorCol = std::max(0, std::min(m_Dims.nCols - 1, c));
+}
+
+Board::Pos Terminal::getCursorPos() const
+{
+    if (m_Dims.nRows == 0 || m_Dims.nCols == 0)
+    {
+        return Board::POS_UNDEFINED;
+    }
+    return static_cast<Board::Pos>(
+        (m_CursorLayer * m_Dims.nRows + m_CursorRow) * m_Dims.nCols
+        + m_CursorCol);
+}
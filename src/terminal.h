@@ -0,0 +1,101 @@
+#ifndef CANH_TERMINAL_H
+#define CANH_TERMINAL_H
+
+#include "board.h"
+#include "renderer.h"
+#include "sprite_atlas.h"
+#include "timer.h"
+#include "topology.h"
+
+#include <termios.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// The ANSI terminal frontend, for playing over SSH. Each cell takes two
+// columns; a cursor moved with the arrow keys (or hjkl) stands in for the
+// mouse. Frames are composed in a screen buffer and compared against a
+// shadow of what the terminal already shows, so present() only sends escape
+// sequences for the characters that changed.
+//
+// Keys: space or enter opens, f flags, u undoes, ctrl-r redoes, r starts a
+// new game and q quits.
+class Terminal : public Renderer
+{
+public:
+    class Exception : public std::runtime_error
+    {
+    public:
+        Exception(const std::string &msg) : std::runtime_error(msg) {}
+    };
+
+    // Switches the terminal to raw mode and the alternate screen until
+    // destroyed
+    Terminal();
+    ~Terminal();
+
+    void drawBoard(const Dims &dims, const uint8_t *sprites) override;
+    void drawBanner(Board::Size nMinesRemaining, Timer::Sec sec,
+        SpriteAtlas::Sprite emoji) override;
+    void present() override;
+    bool pollInput(Input &input, int timeoutMs) override;
+
+private:
+    enum Style : uint8_t
+    {
+        PLAIN,
+        HIDDEN,
+        FLAG,
+        QUESTION_MARK,
+        MINE,
+        MINE_WRONG,
+        MINE_CURRENT,
+        NUMBER,             // followed by one style per value 1 to 8
+
+        CURSOR = 0x80       // combined with any style above
+    };
+
+    struct Char
+    {
+        char ch;
+        uint8_t style;
+
+        bool operator==(const Char &o) const
+        {
+            return ch == o.ch && style == o.style;
+        }
+    };
+
+    static const int CELL_W = 2;
+    static const int BOARD_Y = 2;
+
+    struct termios m_SavedTermios;
+    int m_NRows;
+    int m_NCols;
+    std::vector<Char> m_Screen;
+    std::vector<Char> m_Shadow;
+    std::string m_Out;
+    std::string m_In;
+
+    Dims m_Dims;
+    int m_CursorLayer;
+    int m_CursorRow;
+    int m_CursorCol;
+    int m_ViewX;
+    int m_ViewY;
+
+    // Returns true if the window size changed since the last call
+    bool resize();
+    void put(int y, int x, const char *text, uint8_t style);
+    void appendStyle(uint8_t style);
+    void write(const std::string &data) const;
+
+    bool readInput(int timeoutMs);
+    Input mapKey();
+    void moveCursor(int dRow, int dCol);
+    Board::Pos getCursorPos() const;
+};
+
+#endif
@@ -17,6 +17,21 @@ void Timer::stop()
     }
 }
 
+void Timer::resume()
+{
+    if (!m_Running)
+    {
+        m_StartTime += std::chrono::system_clock::now() - m_StopTime;
+        m_Running = true;
+    }
+}
+
+void Timer::reset()
+{
+    m_StartTime = m_StopTime = std::chrono::system_clock::now();
+    m_Running = false;
+}
+
 Timer::Sec Timer::getSecond() const
 {
     std::chrono::seconds sec;
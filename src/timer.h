@@ -12,6 +12,8 @@ public:
 
     void start();
     void stop();
+    void resume();
+    void reset();
     Sec getSecond() const;
 
 private:
@@ -0,0 +1,5 @@
+#include "topology.h"
+
+constexpr Offset SquareTopology::OFFSETS[];
+constexpr Offset HexTopology::OFFSETS[][HexTopology::N_NEIGHBORS];
+constexpr Offset CubeTopology::OFFSETS[];
@@ -0,0 +1,182 @@
+#ifndef CANH_TOPOLOGY_H
+#define CANH_TOPOLOGY_H
+
+#include <cstdint>
+
+// Topology policies for BasicBoard. Each one provides a compile-time table of
+// neighbor offsets and the screen layout used for drawing and hit-testing, so
+// the per-cell paths are specialized per topology without virtual dispatch.
+//
+// Coordinates are (layer, row, col); only CubeTopology uses more than one
+// layer. Screen positions are expressed in cell units scaled by the caller.
+
+struct Offset
+{
+    int8_t dl;
+    int8_t dr;
+    int8_t dc;
+};
+
+struct Dims
+{
+    int nLayers;
+    int nRows;
+    int nCols;
+};
+
+struct SquareTopology
+{
+    static constexpr unsigned N_NEIGHBORS = 8;
+    static constexpr bool WRAP = false;
+    static constexpr bool LAYERED = false;
+    static constexpr Offset OFFSETS[N_NEIGHBORS] = {
+        {0, -1, -1}, {0, -1, 0}, {0, -1, 1},
+        {0,  0, -1},             {0,  0, 1},
+        {0,  1, -1}, {0,  1, 0}, {0,  1, 1}
+    };
+
+    static const Offset *getOffsets(int) { return OFFSETS; }
+
+    static int getLayoutCols(const Dims &d) { return d.nCols; }
+    static int getLayoutRows(const Dims &d) { return d.nRows; }
+
+    static void getCellOrigin(const Dims &, int, int r, int c,
+        int w, int h, int &x, int &y)
+    {
+        x = c * w;
+        y = r * h;
+    }
+
+    static bool getCellAt(const Dims &d, int x, int y, int w, int h,
+        int &l, int &r, int &c)
+    {
+        l = 0;
+        r = y / h;
+        c = x / w;
+        return 0 <= x && 0 <= y && r < d.nRows && c < d.nCols;
+    }
+};
+
+// The square grid with opposite edges glued together. Boards must be at least
+// 3x3 so that no cell sees the same neighbor twice.
+struct TorusTopology : SquareTopology
+{
+    static constexpr bool WRAP = true;
+};
+
+// Pointy-top hexagons in "odd-r" layout: odd rows are shifted half a cell to
+// the right, so the offsets depend on the row parity.
+struct HexTopology
+{
+    static constexpr unsigned N_NEIGHBORS = 6;
+    static constexpr bool WRAP = false;
+    static constexpr bool LAYERED = false;
+    static constexpr Offset OFFSETS[2][N_NEIGHBORS] = {
+        {{0, -1, -1}, {0, -1, 0}, {0, 0, -1}, {0, 0, 1}, {0, 1, -1}, {0, 1, 0}},
+        {{0, -1,  0}, {0, -1, 1}, {0, 0, -1}, {0, 0, 1}, {0, 1,  0}, {0, 1, 1}}
+    };
+
+    static const Offset *getOffsets(int r) { return OFFSETS[r & 1]; }
+
+    static int getLayoutCols(const Dims &d) { return d.nCols + 1; }
+    static int getLayoutRows(const Dims &d) { return d.nRows; }
+
+    static void getCellOrigin(const Dims &, int, int r, int c,
+        int w, int h, int &x, int &y)
+    {
+        x = c * w + (r & 1) * w / 2;
+        y = r * h;
+    }
+
+    static bool getCellAt(const Dims &d, int x, int y, int w, int h,
+        int &l, int &r, int &c)
+    {
+        l = 0;
+        r = y / h;
+        x -= (r & 1) * w / 2;
+        c = x / w;
+        return 0 <= x && 0 <= y && r < d.nRows && c < d.nCols;
+    }
+};
+
+// A stack of square layers where every cell touches the 26 cells of the
+// surrounding 3x3x3 cube. Layers are drawn side by side with a one cell gap.
+struct CubeTopology
+{
+    static constexpr unsigned N_NEIGHBORS = 26;
+    static constexpr bool WRAP = false;
+    static constexpr bool LAYERED = true;
+    static constexpr Offset OFFSETS[N_NEIGHBORS] = {
+        {-1, -1, -1}, {-1, -1, 0}, {-1, -1, 1},
+        {-1,  0, -1}, {-1,  0, 0}, {-1,  0, 1},
+        {-1,  1, -1}, {-1,  1, 0}, {-1,  1, 1},
+        { 0, -1, -1}, { 0, -1, 0}, { 0, -1, 1},
+        { 0,  0, -1},              { 0,  0, 1},
+        { 0,  1, -1}, { 0,  1, 0}, { 0,  1, 1},
+        { 1, -1, -1}, { 1, -1, 0}, { 1, -1, 1},
+        { 1,  0, -1}, { 1,  0, 0}, { 1,  0, 1},
+        { 1,  1, -1}, { 1,  1, 0}, { 1,  1, 1}
+    };
+
+    static const Offset *getOffsets(int) { return OFFSETS; }
+
+    static int getLayoutCols(const Dims &d)
+    {
+        return d.nLayers * (d.nCols + 1) - 1;
+    }
+    static int getLayoutRows(const Dims &d) { return d.nRows; }
+
+    static void getCellOrigin(const Dims &d, int l, int r, int c,
+        int w, int h, int &x, int &y)
+    {
+        x = (l * (d.nCols + 1) + c) * w;
+        y = r * h;
+    }
+
+    static bool getCellAt(const Dims &d, int x, int y, int w, int h,
+        int &l, int &r, int &c)
+    {
+        if (x < 0 || y < 0)
+        {
+            return false;
+        }
+        int col = x / w;
+        l = col / (d.nCols + 1);
+        c = col % (d.nCols + 1);
+        r = y / h;
+        return l < d.nLayers && c < d.nCols && r < d.nRows;
+    }
+};
+
+// Calls f(p) for every neighbor of the cell at linear position p, where
+// p = (l * nRows + r) * nCols + c. The offset table and the wrap flag are
+// compile-time constants, so the loop is fully specialized per topology.
+template <typename Topology, typename Pos, typename F>
+inline void forEachNeighbor(const Dims &d, Pos p, F f)
+{
+    int layerSize = d.nRows * d.nCols;
+    int l = p / layerSize;
+    int r = (p % layerSize) / d.nCols;
+    int c = p % d.nCols;
+
+    const Offset *offsets = Topology::getOffsets(r);
+    for (unsigned k = 0; k < Topology::N_NEIGHBORS; k ++)
+    {
+        int z = l + offsets[k].dl;
+        int y = r + offsets[k].dr;
+        int x = c + offsets[k].dc;
+        if (Topology::WRAP)
+        {
+            y = (y + d.nRows) % d.nRows;
+            x = (x + d.nCols) % d.nCols;
+        }
+        else if (z < 0 || z >= d.nLayers || y < 0 || y >= d.nRows
+            || x < 0 || x >= d.nCols)
+        {
+            continue;
+        }
+        f(static_cast<Pos>((z * d.nRows + y) * d.nCols + x));
+    }
+}
+
+#endif
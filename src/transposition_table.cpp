@@ -0,0 +1,65 @@
+#include "transposition_table.h"
+
+#include <cstring>
+
+TranspositionTable::TranspositionTable(unsigned log2Size)
+    : m_Mask((static_cast<size_t>(1) << log2Size) - 1),
+    m_Slots(new Slot[m_Mask + 1])
+{
+    for (size_t i = 0; i <= m_Mask; i ++)
+    {
+        m_Slots[i].seq.store(0, std::memory_order_relaxed);
+        m_Slots[i].key.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool TranspositionTable::find(uint64_t key, Result &result) const
+{
+    const Slot &slot = m_Slots[key & m_Mask];
+
+    uint32_t seq = slot.seq.load(std::memory_order_acquire);
+    if (seq & 1)
+    {
+        return false;
+    }
+
+    uint64_t words[N_WORDS];
+    uint64_t slotKey = slot.key.load(std::memory_order_relaxed);
+    for (unsigned i = 0; i < N_WORDS; i ++)
+    {
+        words[i] = slot.words[i].load(std::memory_order_relaxed);
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) != seq || slotKey != key)
+    {
+        return false;
+    }
+
+    std::memcpy(&result, words, sizeof(Result));
+    return true;
+}
+
+void TranspositionTable::store(uint64_t key, const Result &result)
+{
+    Slot &slot = m_Slots[key & m_Mask];
+
+    uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+    if ((seq & 1) || !slot.seq.compare_exchange_strong(seq, seq + 1,
+        std::memory_order_acquire))
+    {
+        // Someone else is writing this slot, their result is as good
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    uint64_t words[N_WORDS] = {};
+    std::memcpy(words, &result, sizeof(Result));
+
+    slot.key.store(key, std::memory_order_relaxed);
+    for (unsigned i = 0; i < N_WORDS; i ++)
+    {
+        slot.words[i].store(words[i], std::memory_order_relaxed);
+    }
+    slot.seq.store(seq + 2, std::memory_order_release);
+}
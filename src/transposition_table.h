@@ -0,0 +1,47 @@
+#ifndef CANH_TRANSPOSITION_TABLE_H
+#define CANH_TRANSPOSITION_TABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+// Bounded, lock-free cache of solver results keyed by the hash of a frontier
+// component. Any number of threads may find() and store() concurrently. Each
+// slot is guarded by a sequence counter: writers make it odd while they copy
+// the result in, and readers drop whatever they copied if the counter moved.
+// Colliding stores simply replace the previous entry.
+class TranspositionTable
+{
+public:
+    static const unsigned MAX_CELLS = 32;
+
+    // Mine probability of every unknown cell of a component, in the
+    // component's canonical order, scaled to 0..255. 0 and 255 are only used
+    // for cells that are safe or mines in every solution.
+    struct Result
+    {
+        uint8_t nCells;
+        uint8_t probabilities[MAX_CELLS];
+    };
+
+    explicit TranspositionTable(unsigned log2Size);
+
+    bool find(uint64_t key, Result &result) const;
+    void store(uint64_t key, const Result &result);
+
+private:
+    static const unsigned N_WORDS = (sizeof(Result) + 7) / 8;
+
+    struct Slot
+    {
+        std::atomic<uint32_t> seq;
+        std::atomic<uint64_t> key;
+        std::atomic<uint64_t> words[N_WORDS];
+    };
+
+    size_t m_Mask;
+    std::unique_ptr<Slot[]> m_Slots;
+};
+
+#endif
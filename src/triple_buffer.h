@@ -0,0 +1,47 @@
+#ifndef CANH_TRIPLE_BUFFER_H
+#define CANH_TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+// Hands the latest value from one producer thread to one consumer thread
+// without either of them ever waiting. The producer fills getBack() and
+// publishes it; the consumer's read() returns the most recently published
+// value, which stays untouched until its next read().
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : m_Middle(1), m_Back(2), m_Front(0) {}
+
+    T &getBack() { return m_Buffers[m_Back]; }
+
+    void publish()
+    {
+        uint8_t prev = m_Middle.exchange(m_Back | DIRTY,
+            std::memory_order_acq_rel);
+        m_Back = prev & INDEX;
+    }
+
+    const T &read()
+    {
+        if (m_Middle.load(std::memory_order_relaxed) & DIRTY)
+        {
+            uint8_t prev = m_Middle.exchange(m_Front,
+                std::memory_order_acq_rel);
+            m_Front = prev & INDEX;
+        }
+        return m_Buffers[m_Front];
+    }
+
+private:
+    static const uint8_t INDEX = 0x3;
+    static const uint8_t DIRTY = 0x4;
+
+    T m_Buffers[3];
+    std::atomic<uint8_t> m_Middle;
+    uint8_t m_Back;
+    uint8_t m_Front;
+};
+
+#endif
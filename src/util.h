@@ -23,6 +23,20 @@ public:
     static std::default_random_engine getRNG() {
         return std::default_random_engine(std::chrono::system_clock::now().time_since_epoch().count());
     }
+
+    // Fixed by the first call, which main makes before anything else
+    static std::chrono::steady_clock::time_point getStartTime() {
+        static const auto startTime = std::chrono::steady_clock::now();
+        return startTime;
+    }
+
+    // splitmix64 finalizer, a cheap well-mixed 64-bit hash
+    static uint64_t mix(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
 };
 
 #endif
@@ -0,0 +1,106 @@
+#include "board.h"
+#include "topology.h"
+
+#include <cstdlib>
+#include <iostream>
+
+// Checks Board on its own: opening a large, nearly empty board, whose single
+// region used to overflow the call stack, and batches on finished games.
+
+namespace
+{
+    template <typename T>
+    unsigned openLarge(const char *name, unsigned nRows, unsigned nCols,
+        unsigned nLayers)
+    {
+        // The clicked cell may touch the mine, so try seeds until it is a zero
+        // and the whole board is one region
+        BasicBoard<T> board(nRows, nCols, 1, nLayers, 0);
+        typename BasicBoard<T>::Pos first = board.convertPos(nRows / 2,
+            nCols / 2);
+        board.open(first);
+        for (typename BasicBoard<T>::Seed seed = 1; board.getValue(first) != 0;
+            seed ++)
+        {
+            board = BasicBoard<T>(nRows, nCols, 1, nLayers, seed);
+            board.open(first);
+        }
+        if (!board.isWon())
+        {
+            std::cerr << name << ": opening a board with one mine did not win"
+                      << std::endl;
+            return 1;
+        }
+        for (typename BasicBoard<T>::Pos p = 0; p < board.getNCells(); p ++)
+        {
+            bool mine = board.getValue(p) == BasicBoard<T>::Cell::MINE;
+            if (mine == (board.getState(p) == BasicBoard<T>::Cell::SHOWN))
+            {
+                std::cerr << name << ": cell " << p << " opened wrongly"
+                          << std::endl;
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    // Once a game is won or lost, a batch changes no cell
+    unsigned flagFinished()
+    {
+        unsigned nFailures = 0;
+        Board won(9, 9, 10, 1, 7);
+        won.open(won.convertPos(4, 4));
+        Board::Pos mine = Board::POS_UNDEFINED;
+        Board::Pos other = Board::POS_UNDEFINED;
+        for (Board::Pos p = 0; p < won.getNCells(); p ++)
+        {
+            if (won.getValue(p) == Board::Cell::MINE)
+            {
+                other = mine;
+                mine = p;
+            }
+            else
+            {
+                won.open(p);
+            }
+        }
+        Board::Command flag = {Board::Command::FLAG, mine};
+        if (!won.isWon() || !won.apply(&flag, 1).changed.empty()
+            || won.getState(mine) != Board::Cell::HIDDEN)
+        {
+            std::cerr << "batch flagged a cell of a won game" << std::endl;
+            nFailures ++;
+        }
+
+        Board lost(9, 9, 10, 1, 7);
+        lost.open(lost.convertPos(4, 4));
+        Board::Command commands[] = {
+            {Board::Command::OPEN, mine},
+            {Board::Command::FLAG, other}
+        };
+        lost.apply(commands, 2);
+        if (!lost.isLost() || lost.getState(other) != Board::Cell::HIDDEN)
+        {
+            std::cerr << "batch flagged a cell of a lost game" << std::endl;
+            nFailures ++;
+        }
+        return nFailures;
+    }
+}
+
+int main()
+{
+    unsigned nFailures = 0;
+    nFailures += openLarge<SquareTopology>("square", 1000, 1000, 1);
+    nFailures += openLarge<TorusTopology>("torus", 500, 500, 1);
+    nFailures += openLarge<HexTopology>("hex", 500, 500, 1);
+    nFailures += openLarge<CubeTopology>("cube", 300, 300, 3);
+    nFailures += flagFinished();
+
+    if (nFailures != 0)
+    {
+        std::cerr << nFailures << " failures" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,293 @@
+#include "board.h"
+#include "concurrent_board.h"
+#include "topology.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Checks the cell values of a BasicConcurrentBoard against a BasicBoard with
+// the same seed and first click, in every topology: once after a single
+// open, and once after several threads opened and flagged cells while the
+// mines were being placed. Then races threads on one game: opening
+// overlapping regions, and opening a mine against the winning open while
+// the mine is being flagged, and checks that the outcome and the counters
+// agree with the cells.
+
+namespace
+{
+    const unsigned N_SEEDS = 50;
+    const unsigned N_THREADS = 4;
+
+    void race(unsigned nThreads, const std::function<void(unsigned)> &work)
+    {
+        std::atomic<bool> go(false);
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < nThreads; t ++)
+        {
+            threads.emplace_back([&, t]() {
+                while (!go)
+                {
+                }
+                work(t);
+            });
+        }
+        go = true;
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    // The hidden and flagged counters match the cells, and a won game shows
+    // every safe cell and no mine
+    template <typename T>
+    bool isConsistent(const BasicConcurrentBoard<T> &board)
+    {
+        typedef typename BasicConcurrentBoard<T>::Cell Cell;
+        typename BasicConcurrentBoard<T>::Size nHidden = 0, nFlagged = 0;
+        typename BasicConcurrentBoard<T>::Size nMinesShown = 0;
+        for (typename BasicConcurrentBoard<T>::Pos p = 0;
+            p < static_cast<typename BasicConcurrentBoard<T>::Pos>(
+                board.getNCells()); p ++)
+        {
+            bool mine = board.getValue(p) == Cell::MINE;
+            if (board.getState(p) != Cell::SHOWN)
+            {
+                nHidden ++;
+            }
+            else if (mine)
+            {
+                nMinesShown ++;
+            }
+            if (board.getState(p) == Cell::FLAGGED)
+            {
+                nFlagged ++;
+            }
+        }
+        if (nHidden != board.getNHidden() || nFlagged != board.getNFlagged()
+            || nMinesShown > 1)
+        {
+            return false;
+        }
+        return !board.isWon()
+            || (nMinesShown == 0 && nHidden == board.getNMines());
+    }
+
+    template <typename T>
+    unsigned compare(const char *name, unsigned nRows, unsigned nCols,
+        unsigned nMines, unsigned nLayers)
+    {
+        unsigned nFailures = 0;
+        for (unsigned seed = 0; seed < N_SEEDS; seed ++)
+        {
+            BasicBoard<T> board(nRows, nCols, nMines, nLayers, seed);
+            BasicConcurrentBoard<T> concurrent(nRows, nCols, nMines, nLayers,
+                seed);
+            typename BasicBoard<T>::Pos first = board.convertPos(nRows / 2,
+                nCols / 2);
+            board.open(first);
+            concurrent.open(first);
+
+            for (typename BasicBoard<T>::Pos p = 0; p < board.getNCells();
+                p ++)
+            {
+                if (board.getValue(p) != concurrent.getValue(p)
+                    || board.getState(p) != concurrent.getState(p))
+                {
+                    std::cerr << name << " seed " << seed << ": cell " << p
+                              << " differs" << std::endl;
+                    nFailures ++;
+                    break;
+                }
+            }
+        }
+
+        // Threads race on the first click while others flag cells, so the
+        // mines are placed under concurrent writes to the same cells
+        for (unsigned seed = 0; seed < N_SEEDS; seed ++)
+        {
+            BasicBoard<T> board(nRows, nCols, nMines, nLayers, seed);
+            BasicConcurrentBoard<T> concurrent(nRows, nCols, nMines, nLayers,
+                seed);
+            std::atomic<bool> go(false);
+            std::vector<std::thread> threads;
+            for (unsigned t = 0; t < N_THREADS; t ++)
+            {
+                threads.emplace_back([&, t]() {
+                    while (!go)
+                    {
+                    }
+                    if (t == 0)
+                    {
+                        concurrent.open(0);
+                        return;
+                    }
+                    for (typename BasicBoard<T>::Pos p = t;
+                        p < board.getNCells(); p += N_THREADS * 3)
+                    {
+                        concurrent.nextState(p);
+                    }
+                });
+            }
+            go = true;
+            for (std::thread &thread : threads)
+            {
+                thread.join();
+            }
+
+            board.open(0);
+            for (typename BasicBoard<T>::Pos p = 0; p < board.getNCells();
+                p ++)
+            {
+                if (board.getValue(p) != concurrent.getValue(p))
+                {
+                    std::cerr << name << " seed " << seed << ": value of "
+                              << p << " differs after racing" << std::endl;
+                    nFailures ++;
+                    break;
+                }
+            }
+        }
+        return nFailures;
+    }
+
+    // Every thread opens every safe cell, each starting somewhere else, so
+    // the flood fills keep running into each other
+    template <typename T>
+    unsigned openOverlapping(const char *name, unsigned nRows,
+        unsigned nCols, unsigned nMines, unsigned nLayers)
+    {
+        unsigned nFailures = 0;
+        for (unsigned seed = 0; seed < N_SEEDS; seed ++)
+        {
+            BasicBoard<T> board(nRows, nCols, nMines, nLayers, seed);
+            BasicConcurrentBoard<T> concurrent(nRows, nCols, nMines, nLayers,
+                seed);
+            typename BasicBoard<T>::Pos first = board.convertPos(nRows / 2,
+                nCols / 2);
+            board.open(first);
+            concurrent.open(first);
+
+            std::vector<typename BasicBoard<T>::Pos> safe;
+            for (typename BasicBoard<T>::Pos p = 0; p < board.getNCells();
+                p ++)
+            {
+                if (board.getValue(p) != BasicBoard<T>::Cell::MINE)
+                {
+                    safe.push_back(p);
+                }
+            }
+            race(N_THREADS, [&](unsigned t) {
+                size_t start = t * safe.size() / N_THREADS;
+                for (size_t i = 0; i < safe.size(); i ++)
+                {
+                    concurrent.open(safe[(start + i) % safe.size()]);
+                }
+            });
+
+            if (!concurrent.isWon() || !isConsistent(concurrent))
+            {
+                std::cerr << name << " seed " << seed << ": overlapping"
+                          << " opens did not win consistently" << std::endl;
+                nFailures ++;
+            }
+        }
+        return nFailures;
+    }
+
+    // With one safe cell left, one thread opens it and wins while another
+    // opens a mine that a third one keeps cycling through its states.
+    // Exactly one of the opens ends the game.
+    template <typename T>
+    unsigned raceMineAgainstWin(const char *name, unsigned nRows,
+        unsigned nCols, unsigned nMines, unsigned nLayers)
+    {
+        const unsigned N_ROUNDS = 20;
+        unsigned nFailures = 0;
+        for (unsigned seed = 0; seed < N_SEEDS * N_ROUNDS; seed ++)
+        {
+            BasicConcurrentBoard<T> concurrent(nRows, nCols, nMines, nLayers,
+                seed);
+            typename BasicBoard<T>::Pos first = concurrent.convertPos(
+                nRows / 2, nCols / 2);
+            concurrent.open(first);
+
+            typename BasicBoard<T>::Pos last = BasicBoard<T>::POS_UNDEFINED;
+            typename BasicBoard<T>::Pos mine = BasicBoard<T>::POS_UNDEFINED;
+            for (typename BasicBoard<T>::Pos p = 0;
+                p < static_cast<typename BasicBoard<T>::Pos>(
+                    concurrent.getNCells()); p ++)
+            {
+                if (concurrent.getValue(p) == BasicBoard<T>::Cell::MINE)
+                {
+                    mine = p;
+                }
+                else if (concurrent.getState(p) != BasicBoard<T>::Cell::SHOWN)
+                {
+                    if (concurrent.getNHidden() == concurrent.getNMines() + 1)
+                    {
+                        last = p;
+                        break;
+                    }
+                    concurrent.open(p);
+                }
+            }
+            if (last == BasicBoard<T>::POS_UNDEFINED
+                || mine == BasicBoard<T>::POS_UNDEFINED)
+            {
+                continue;
+            }
+
+            race(3, [&](unsigned t) {
+                if (t == 0)
+                {
+                    concurrent.open(last);
+                }
+                else if (t == 1)
+                {
+                    concurrent.open(mine);
+                }
+                else
+                {
+                    while (!concurrent.isWon() && !concurrent.isLost())
+                    {
+                        concurrent.nextState(mine);
+                    }
+                }
+            });
+
+            if (concurrent.isWon() == concurrent.isLost()
+                || !isConsistent(concurrent))
+            {
+                std::cerr << name << " seed " << seed << ": mine and winning"
+                          << " open ended inconsistently" << std::endl;
+                nFailures ++;
+            }
+        }
+        return nFailures;
+    }
+}
+
+int main()
+{
+    unsigned nFailures = 0;
+    nFailures += compare<SquareTopology>("square", 16, 30, 99, 1);
+    nFailures += compare<TorusTopology>("torus", 16, 30, 99, 1);
+    nFailures += compare<HexTopology>("hex", 16, 30, 99, 1);
+    nFailures += compare<CubeTopology>("cube", 8, 8, 40, 3);
+    nFailures += openOverlapping<SquareTopology>("square", 16, 30, 99, 1);
+    nFailures += openOverlapping<TorusTopology>("torus", 16, 30, 99, 1);
+    nFailures += raceMineAgainstWin<SquareTopology>("square", 9, 9, 10, 1);
+    nFailures += raceMineAgainstWin<HexTopology>("hex", 9, 9, 10, 1);
+
+    if (nFailures != 0)
+    {
+        std::cerr << nFailures << " failures" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,73 @@
+#include "game_stats.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// Writes blocks of records and checks the column bounds read back from the
+// block headers, with seeds on both sides of 2^63.
+
+int main()
+{
+    const std::string path = "build/tests/game_stats_test.bin";
+    std::remove(path.c_str());
+
+    const uint64_t seeds[] = {UINT64_MAX, 1, UINT64_C(1) << 63,
+        (UINT64_C(1) << 63) - 1};
+    {
+        GameStatsWriter writer(path, 4);
+        for (uint64_t seed : seeds)
+        {
+            GameRecord record = {};
+            record.seed = seed;
+            record.nRows = 16;
+            record.nCols = 30;
+            record.nMines = 99;
+            writer.append(record);
+        }
+    }
+
+    unsigned nFailures = 0;
+    GameStatsReader reader(path);
+    if (reader.getBlocks().size() != 1 || reader.getNRecords() != 4)
+    {
+        std::cerr << "expected one block of 4 records" << std::endl;
+        nFailures ++;
+    }
+    else
+    {
+        // Compared as stored, as the query tool skips blocks by them
+        const GameStats::BlockHeader &h = *reader.getBlocks()[0].header;
+        for (unsigned c = 0; c < GameStats::N_COLUMNS; c ++)
+        {
+            if (h.min[c] > h.max[c])
+            {
+                std::cerr << "bounds of column " << c << " out of order"
+                          << std::endl;
+                nFailures ++;
+            }
+        }
+        if (h.min[GameStats::SEED] != 1
+            || h.max[GameStats::SEED] != UINT64_MAX)
+        {
+            std::cerr << "seed bounds " << h.min[GameStats::SEED] << ".."
+                      << h.max[GameStats::SEED] << std::endl;
+            nFailures ++;
+        }
+        if (h.min[GameStats::N_COLS] != 30 || h.max[GameStats::N_COLS] != 30)
+        {
+            std::cerr << "column bounds wrong" << std::endl;
+            nFailures ++;
+        }
+    }
+    std::remove(path.c_str());
+
+    if (nFailures != 0)
+    {
+        std::cerr << nFailures << " failures" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
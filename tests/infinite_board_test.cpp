@@ -0,0 +1,37 @@
+#include "infinite_board.h"
+
+#include <cstdlib>
+#include <iostream>
+
+// Opens InfiniteBoards at the lowest density they accept. Below the
+// percolation density a single open never finished; at MIN_DENSITY every
+// first open must end in a region of bounded size.
+
+namespace
+{
+    const unsigned N_SEEDS = 200;
+    const size_t MAX_OPENED = 100000;
+}
+
+int main()
+{
+    unsigned nFailures = 0;
+    for (InfiniteBoard::Seed seed = 0; seed < N_SEEDS; seed ++)
+    {
+        InfiniteBoard board(InfiniteBoard::MIN_DENSITY, seed);
+        board.open(0, 0);
+        if (board.isLost() || board.getNOpened() > MAX_OPENED)
+        {
+            std::cerr << "seed " << seed << ": first open lost or opened "
+                      << board.getNOpened() << " cells" << std::endl;
+            nFailures ++;
+        }
+    }
+
+    if (nFailures != 0)
+    {
+        std::cerr << nFailures << " failures" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+#include "board.h"
+#include "solver.h"
+#include "transposition_table.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Plays seeded games on several threads that share one small table, so
+// they keep evicting and overwriting each other's entries, and checks every
+// analysis against the board's mines and against a Solver with a table of
+// its own.
+
+namespace
+{
+    const unsigned N_THREADS = 4;
+    const unsigned N_GAMES = 40;
+
+    bool same(const Solver::Analysis &a, const Solver::Analysis &b)
+    {
+        return a.safe == b.safe && a.mines == b.mines
+            && a.probabilities == b.probabilities;
+    }
+
+    unsigned play(TranspositionTable &shared, Board::Seed seed)
+    {
+        Solver solver(shared);
+        TranspositionTable own(16);
+        Solver reference(own);
+        unsigned nFailures = 0;
+
+        Board board(16, 16, 40, 1, seed);
+        board.open(board.convertPos(8, 8));
+        while (!board.isWon() && !board.isLost())
+        {
+            const Solver::Analysis &analysis = solver.analyse(board);
+            if (!same(analysis, reference.analyse(board)))
+            {
+                std::cerr << "seed " << seed << ": shared table differs"
+                          << std::endl;
+                nFailures ++;
+            }
+
+            std::vector<Board::Command> commands;
+            for (Board::Pos p : analysis.safe)
+            {
+                if (board.getValue(p) == Board::Cell::MINE)
+                {
+                    std::cerr << "seed " << seed << ": mine " << p
+                              << " deduced safe" << std::endl;
+                    nFailures ++;
+                }
+                commands.push_back({Board::Command::OPEN, p});
+            }
+            for (Board::Pos p : analysis.mines)
+            {
+                if (board.getValue(p) != Board::Cell::MINE)
+                {
+                    std::cerr << "seed " << seed << ": cell " << p
+                              << " deduced a mine" << std::endl;
+                    nFailures ++;
+                }
+                commands.push_back({Board::Command::FLAG, p});
+            }
+            if (commands.empty())
+            {
+                // Stop at the first guess; only deductions are checked
+                break;
+            }
+            board.apply(commands.data(), commands.size());
+        }
+        return nFailures;
+    }
+}
+
+int main()
+{
+    TranspositionTable shared(6);
+    std::atomic<unsigned> nFailures(0);
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < N_THREADS; t ++)
+    {
+        threads.emplace_back([&, t]() {
+            for (unsigned g = 0; g < N_GAMES; g ++)
+            {
+                nFailures += play(shared, t * N_GAMES + g);
+            }
+        });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    // After opening a corner, a 2x2 board and a 1x4 board with its mine
+    // next to the corner look the same to the hash, but only on the 1x4
+    // one is the mine certain
+    TranspositionTable table(8);
+    Solver solver(table);
+    Board square(2, 2, 1);
+    square.open(0);
+    for (Board::Seed seed = 0; ; seed ++)
+    {
+        Board line(1, 4, 1, 1, seed);
+        line.open(0);
+        if (line.getValue(0) != 1)
+        {
+            continue;
+        }
+        if (line.getHash() != square.getHash())
+        {
+            std::cerr << "hash depends on the board size" << std::endl;
+            break;
+        }
+        solver.analyse(square);
+        if (solver.analyse(line).mines != std::vector<Board::Pos>{1})
+        {
+            std::cerr << "analysis of another board size reused"
+                      << std::endl;
+            nFailures ++;
+        }
+        break;
+    }
+
+    if (nFailures != 0)
+    {
+        std::cerr << nFailures << " failures" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,56 @@
+#include "sprite_atlas.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Checks SpriteAtlas::translateRow against getCellSprite for every game
+// state, on rows of every length up to a few vectors, so that both the
+// sixteen cell steps and the cells left over are covered.
+
+int main()
+{
+    const size_t MAX_LENGTH = 100;
+    std::mt19937 rng(1);
+    unsigned nFailures = 0;
+
+    for (unsigned gameState = Board::INIT; gameState <= Board::LOST;
+        gameState ++)
+    {
+        for (size_t n = 0; n <= MAX_LENGTH; n ++)
+        {
+            std::vector<uint8_t> cells(n), sprites(n);
+            for (size_t i = 0; i < n; i ++)
+            {
+                // Every packed cell value appears across the row lengths
+                cells[i] = static_cast<uint8_t>(i < 64 ? (i + n) % 64 : rng());
+            }
+            SpriteAtlas::translateRow(static_cast<Board::State>(gameState),
+                cells.data(), n, sprites.data());
+
+            for (size_t i = 0; i < n; i ++)
+            {
+                SpriteAtlas::Sprite expected = SpriteAtlas::getCellSprite(
+                    static_cast<Board::State>(gameState),
+                    static_cast<Board::Cell::State>(cells[i] >> 4 & 0x3),
+                    cells[i] & 0xF);
+                if (sprites[i] != expected)
+                {
+                    std::cerr << "game state " << gameState << ", row of "
+                              << n << ": cell " << i << " differs"
+                              << std::endl;
+                    nFailures ++;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (nFailures != 0)
+    {
+        std::cerr << nFailures << " failures" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
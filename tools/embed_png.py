@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""Decodes a PNG into RGBA and prints it as the C++ definition of
+SpriteAtlas::PIXELS, so the game does not need to read or decode the image
+at startup. Only the Python standard library is used.
+
+Usage: embed_png.py sprite.png > sprite_pixels.cpp
+"""
+
+import struct
+import sys
+import zlib
+
+CHANNELS = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}
+
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    return b if pb <= pc else c
+
+
+def unfilter(data, width, height, bpp):
+    stride = width * bpp
+    rows = []
+    prev = bytearray(stride)
+    pos = 0
+    for _ in range(height):
+        kind = data[pos]
+        row = bytearray(data[pos + 1:pos + 1 + stride])
+        pos += 1 + stride
+        for i in range(stride):
+            a = row[i - bpp] if i >= bpp else 0
+            b = prev[i]
+            c = prev[i - bpp] if i >= bpp else 0
+            if kind == 1:
+                row[i] = (row[i] + a) & 0xFF
+            elif kind == 2:
+                row[i] = (row[i] + b) & 0xFF
+            elif kind == 3:
+                row[i] = (row[i] + (a + b) // 2) & 0xFF
+            elif kind == 4:
+                row[i] = (row[i] + paeth(a, b, c)) & 0xFF
+            elif kind != 0:
+                raise ValueError('bad filter type %d' % kind)
+        rows.append(row)
+        prev = row
+    return rows
+
+
+def decode(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        raise ValueError('not a PNG file')
+
+    pos = 8
+    idat = b''
+    palette = b''
+    transparency = b''
+    while pos < len(data):
+        length, kind = struct.unpack('>I4s', data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b'IHDR':
+            width, height, depth, color, _, _, interlace = \
+                struct.unpack('>IIBBBBB', body)
+        elif kind == b'PLTE':
+            palette = body
+        elif kind == b'tRNS':
+            transparency = body
+        elif kind == b'IDAT':
+            idat += body
+        elif kind == b'IEND':
+            break
+
+    if depth != 8 or interlace != 0 or color not in CHANNELS:
+        raise ValueError('only 8-bit non-interlaced PNGs are supported')
+
+    bpp = CHANNELS[color]
+    rows = unfilter(zlib.decompress(idat), width, height, bpp)
+
+    pixels = bytearray()
+    for row in rows:
+        for x in range(width):
+            px = row[x * bpp:(x + 1) * bpp]
+            if color == 0:
+                pixels += bytes((px[0], px[0], px[0], 255))
+            elif color == 2:
+                pixels += px + b'\xff'
+            elif color == 3:
+                alpha = transparency[px[0]] if px[0] < len(transparency) \
+                    else 255
+                pixels += palette[px[0] * 3:px[0] * 3 + 3] + bytes((alpha,))
+            elif color == 4:
+                pixels += bytes((px[0], px[0], px[0], px[1]))
+            else:
+                pixels += px
+    return width, height, pixels
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__.strip().splitlines()[-1])
+
+    width, height, pixels = decode(sys.argv[1])
+    out = sys.stdout
+    out.write('// Generated from %s by tools/embed_png.py, do not edit\n'
+              % sys.argv[1])
+    out.write('#include "sprite_atlas.h"\n\n')
+    out.write('const SpriteAtlas::Size SpriteAtlas::IMAGE_W = %d;\n' % width)
+    out.write('const SpriteAtlas::Size SpriteAtlas::IMAGE_H = %d;\n\n' % height)
+    out.write('const uint8_t SpriteAtlas::PIXELS[] = {\n')
+    for i in range(0, len(pixels), 16):
+        out.write('    ' + ', '.join('0x%02x' % b for b in pixels[i:i + 16])
+                  + ',\n')
+    out.write('};\n')
+
+
+if __name__ == '__main__':
+    main()